@@ -23,7 +23,7 @@ set CFLAGS=-vn -O3 -compiler=sccz80
 echo Compiling source files...
 
 REM Compile each source file
-for %%f in (screen graphics sound input bstring bmath system vdp) do (
+for %%f in (screen graphics sound input bstring bmath system vdp vram tilemap scroll) do (
     echo   Compiling %%f.c...
     %ZCC% %TARGET% %CFLAGS% -I"%INCDIR%" -c "%SRCDIR%\%%f.c" -o "%SRCDIR%\%%f.o"
     if errorlevel 1 (
@@ -36,7 +36,7 @@ echo.
 echo Creating library...
 
 REM Create library using z80asm
-z80asm -x"%OUTDIR%\msxbasic.lib" "%SRCDIR%\screen.o" "%SRCDIR%\graphics.o" "%SRCDIR%\sound.o" "%SRCDIR%\input.o" "%SRCDIR%\bstring.o" "%SRCDIR%\bmath.o" "%SRCDIR%\system.o" "%SRCDIR%\vdp.o"
+z80asm -x"%OUTDIR%\msxbasic.lib" "%SRCDIR%\screen.o" "%SRCDIR%\graphics.o" "%SRCDIR%\sound.o" "%SRCDIR%\input.o" "%SRCDIR%\bstring.o" "%SRCDIR%\bmath.o" "%SRCDIR%\system.o" "%SRCDIR%\vdp.o" "%SRCDIR%\vram.o" "%SRCDIR%\tilemap.o" "%SRCDIR%\scroll.o"
 
 if errorlevel 1 (
     echo ERROR: Failed to create library
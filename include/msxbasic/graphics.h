@@ -75,6 +75,25 @@ void basic_preset(int16_t x, int16_t y);
  */
 void basic_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
 
+/**
+ * @brief Set the viewport (clip rectangle)
+ * Like VIEW SCREEN (x1,y1)-(x2,y2): coordinates stay absolute and every
+ * drawing primitive (PSET, LINE, box, CIRCLE, PAINT, DRAW, PUT) is clipped
+ * to the rectangle, intersected with the screen of the current mode.
+ * The viewport is kept across SCREEN changes.
+ * @param x1 Left (corners may be given in any order)
+ * @param y1 Top
+ * @param x2 Right (inclusive)
+ * @param y2 Bottom (inclusive)
+ */
+void basic_view(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+/**
+ * @brief Reset the viewport to the whole screen
+ * Equivalent to: VIEW
+ */
+void basic_view_reset(void);
+
 /**
  * @brief Draw a line with style
  * Equivalent to: LINE (x1, y1)-(x2, y2), color, style
@@ -126,9 +145,11 @@ void basic_circle(int16_t x, int16_t y, int16_t radius, uint8_t color);
  * @param y Center Y coordinate
  * @param radius Radius
  * @param color Circle color
- * @param start_deg Start angle in degrees (0-360, ignored in current impl)
- * @param end_deg End angle in degrees (0-360, ignored in current impl)
- * @param aspect_100 Aspect ratio * 100 (100 = circle, ignored in current impl)
+ * The arc runs counterclockwise from start_deg to end_deg; equal angles
+ * (e.g. 0 and 360) draw the whole ellipse.
+ * @param start_deg Start angle in degrees (taken modulo 360)
+ * @param end_deg End angle in degrees (taken modulo 360)
+ * @param aspect_100 Aspect ratio * 100 (100 = circle, >100 = tall, <100 = wide)
  */
 void basic_circle_ex(int16_t x, int16_t y, int16_t radius, uint8_t color,
                      int16_t start_deg, int16_t end_deg, int16_t aspect_100);
@@ -146,6 +167,9 @@ void basic_ellipse(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color);
 /**
  * @brief Paint (flood fill) an area
  * Equivalent to: PAINT (x, y), color, border
+ * Uses a built-in 1 KB work arena (128 pending spans, 170 in SCREEN 5-8).
+ * A complex region that needs more stops partway without notice; use
+ * basic_paint_ex() with a larger arena to fill it and check the result.
  * @param x Start X coordinate
  * @param y Start Y coordinate
  * @param color Fill color
@@ -153,6 +177,29 @@ void basic_ellipse(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color);
  */
 void basic_paint(int16_t x, int16_t y, uint8_t color, uint8_t border);
 
+/* Arena size for basic_paint_ex: scanline cache (at most 256 bytes) +
+ * 6 bytes per span */
+#define PAINT_SPAN_SIZE         6
+#define PAINT_ARENA_SIZE(spans) (256 + (spans) * PAINT_SPAN_SIZE)
+
+/**
+ * @brief Paint (flood fill) using a caller-supplied work arena
+ * Filled spans are written in one operation. In SCREEN 5-8 span ends are
+ * found by the VDP SRCH command; in other modes each scanline is cached
+ * in RAM with one bulk VRAM read. The arena holds the scanline cache
+ * (one byte per pixel of a line, at most 256; not used in SCREEN 5-8)
+ * followed by the span stack.
+ * @param x Start X coordinate
+ * @param y Start Y coordinate
+ * @param color Fill color
+ * @param border Border color (fill stops at this color)
+ * @param arena Work memory (see PAINT_ARENA_SIZE)
+ * @param arena_size Size of arena in bytes
+ * @return 0 if the region was filled completely, 1 if the arena was too small
+ */
+uint8_t basic_paint_ex(int16_t x, int16_t y, uint8_t color, uint8_t border,
+                       uint8_t* arena, uint16_t arena_size);
+
 /**
  * @brief Paint with fill color only
  * Equivalent to: PAINT (x, y), color
@@ -172,6 +219,78 @@ void basic_paint_c(int16_t x, int16_t y, uint8_t color);
  */
 void basic_draw(const char* cmd);
 
+/* Compiled DRAW bytecode (basic_draw_compile). Each op byte holds the
+ * opcode in bits 0-3 and flags in bits 6-7; operands are little-endian. */
+#define DRAW_OP_END     0x00    /* End of program */
+#define DRAW_OP_MOVE8   0x01    /* int8 dx, int8 dy (relative) */
+#define DRAW_OP_MOVE    0x02    /* int16 dx, int16 dy (relative) */
+#define DRAW_OP_MOVETO  0x03    /* int16 x, int16 y (absolute, always updates) */
+#define DRAW_OP_COLOR   0x04    /* uint8 color */
+#define DRAW_FLAG_BLANK     0x80    /* B: move without drawing */
+#define DRAW_FLAG_NOUPDATE  0x40    /* N: draw without moving the pen */
+
+/**
+ * @brief Compile a DRAW string into bytecode
+ * Parses once so that basic_draw_run() can replay the shape without
+ * string parsing. S (scale) and A (angle) are applied at compile time,
+ * so the output matches basic_draw() exactly. The bytecode does not
+ * contain pointers and may be stored in ROM.
+ * @param cmd DRAW command string (null-terminated)
+ * @param code Output buffer, or NULL to only measure the size
+ * @param size Size of the output buffer in bytes
+ * @return Bytes used including DRAW_OP_END, or 0 if the buffer is too small
+ */
+uint16_t basic_draw_compile(const char* cmd, uint8_t* code, uint16_t size);
+
+/**
+ * @brief Replay compiled DRAW bytecode
+ * Starts at (x, y) in the foreground color and updates the graphics
+ * cursor like basic_draw(). Absolute moves (Mx,y) are not offset.
+ * @param code Bytecode from basic_draw_compile()
+ * @param x Start X coordinate
+ * @param y Start Y coordinate
+ */
+void basic_draw_run(const uint8_t* code, int16_t x, int16_t y);
+
+/**
+ * @brief Set the 2D transform for basic_draw_run_xform() and basic_polyline()
+ * Rotation, uniform scale and translation in 8.8 fixed point. Each vertex
+ * is transformed once before the segment is drawn with basic_line().
+ * @param angle Rotation in degrees, counterclockwise (any value)
+ * @param scale Scale factor, 8.8 fixed point (256 = 1:1)
+ * @param tx Screen X of the model origin
+ * @param ty Screen Y of the model origin
+ */
+void basic_xform(int16_t angle, uint16_t scale, int16_t tx, int16_t ty);
+
+/**
+ * @brief Reset the transform to identity
+ */
+void basic_xform_reset(void);
+
+/**
+ * @brief Transform a point with the current transform
+ * @param x X coordinate (in: model, out: screen)
+ * @param y Y coordinate (in: model, out: screen)
+ */
+void basic_xform_point(int16_t* x, int16_t* y);
+
+/**
+ * @brief Replay compiled DRAW bytecode through the current transform
+ * The pen starts at the model origin (0, 0); absolute moves are in
+ * model coordinates too. The graphics cursor ends on the screen pen.
+ * @param code Bytecode from basic_draw_compile()
+ */
+void basic_draw_run_xform(const uint8_t* code);
+
+/**
+ * @brief Draw connected lines through the current transform
+ * @param pts Vertices as x0, y0, x1, y1, ... (model coordinates)
+ * @param count Number of vertices (1 draws a point)
+ * @param color Color code
+ */
+void basic_polyline(const int16_t* pts, uint8_t count, uint8_t color);
+
 /**
  * @brief Get the color of a pixel
  * Equivalent to: POINT(x, y)
@@ -181,6 +300,18 @@ void basic_draw(const char* cmd);
  */
 uint8_t basic_point(int16_t x, int16_t y);
 
+/**
+ * @brief Get the colors of consecutive pixels on one row
+ * Sets the VRAM address once and reads the row in a single stream.
+ * Does not move the graphics cursor.
+ * @param x Left X coordinate
+ * @param y Y coordinate
+ * @param count Number of pixels (clipped at the right screen edge)
+ * @param buf Buffer receiving one color per pixel
+ * @return Number of pixels read
+ */
+uint16_t basic_point_row(int16_t x, int16_t y, uint16_t count, uint8_t* buf);
+
 /**
  * @brief Get current graphics X position
  * @return Current X position
@@ -200,6 +331,145 @@ int16_t basic_grp_y(void);
  */
 void basic_grp_move(int16_t x, int16_t y);
 
+/* === SCREEN 2 RAM shadow === */
+
+/* Buffer size for basic_shadow: pattern + color bytes of 64-line bands */
+#define SHADOW_SIZE(bands)  ((uint16_t)(bands) * 4096)
+
+/**
+ * @brief Draw SCREEN 2/4 into a RAM copy of the pattern and color tables
+ * The current VRAM contents of the bands are loaded into buf. Primitives
+ * then read and write RAM and mark the touched 8x8 cells; basic_flush()
+ * uploads them. Bands outside the shadow are still drawn in VRAM.
+ * CLS clears the shadow as well; SCREEN flushes and drops it, so call
+ * basic_shadow() again after a mode change.
+ * @param buf Buffer of SHADOW_SIZE(bands) bytes
+ * @param first_band First band (0-2, 64 lines each)
+ * @param bands Number of bands (1-3)
+ */
+void basic_shadow(uint8_t* buf, uint8_t first_band, uint8_t bands);
+
+/**
+ * @brief Flush and stop using the RAM shadow
+ */
+void basic_shadow_off(void);
+
+/**
+ * @brief Clear the pattern bytes of the shadowed bands (CLS in RAM)
+ */
+void basic_shadow_clear(void);
+
+/**
+ * @brief Upload the changed cells of the RAM shadow to VRAM
+ * Each run of changed cells on a character row is sent as one pattern
+ * and one color block. Does nothing without a shadow.
+ */
+void basic_flush(void);
+
+/* === Dirty rectangles (SCREEN 5-12) === */
+
+/**
+ * @brief Start tracking the areas drawn by graphics primitives
+ * Every primitive adds the clipped bounding box of what it drew to one of
+ * eight 32-line bands; basic_dirty_restore() repairs them from bg_page.
+ * @param bg_page Page holding the clean background
+ */
+void basic_dirty_track(uint8_t bg_page);
+
+/**
+ * @brief Stop tracking (the recorded areas are kept until cleared)
+ */
+void basic_dirty_stop(void);
+
+/**
+ * @brief Mark an area as damaged (e.g. after direct VRAM writes)
+ * @param x1 Corner X
+ * @param y1 Corner Y
+ * @param x2 Opposite corner X
+ * @param y2 Opposite corner Y
+ */
+void basic_dirty_add(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+
+/**
+ * @brief Copy the damaged areas from the background page to the active page
+ * Issues at most one HMMM per band (bands with equal columns are joined),
+ * widened to whole VRAM bytes, then clears the list.
+ */
+void basic_dirty_restore(void);
+
+/**
+ * @brief Forget the damaged areas without restoring them
+ */
+void basic_dirty_clear(void);
+
+/* === Display lists === */
+
+/**
+ * @brief Start recording a display list
+ * The basic_dl_* drawing functions append to buf instead of drawing.
+ * Arguments are validated while recording (box corners are sorted,
+ * empty copies and invalid sprite planes are dropped).
+ * @param buf Buffer for the list
+ * @param size Size of buf in bytes
+ */
+void basic_dl_begin(uint8_t* buf, uint16_t size);
+
+/**
+ * @brief Finish recording a display list
+ * @return Bytes used including the end marker, or 0 if the buffer was
+ *         too small (the list is then left empty)
+ */
+uint16_t basic_dl_end(void);
+
+/**
+ * @brief Record PSET (x, y), color
+ */
+void basic_dl_pset(int16_t x, int16_t y, uint8_t color);
+
+/**
+ * @brief Record LINE (x1, y1)-(x2, y2), color
+ */
+void basic_dl_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
+
+/**
+ * @brief Record LINE (x1, y1)-(x2, y2), color, B
+ */
+void basic_dl_box(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
+
+/**
+ * @brief Record LINE (x1, y1)-(x2, y2), color, BF
+ */
+void basic_dl_boxfill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
+
+/**
+ * @brief Record COPY (sx, sy)-STEP(width, height) TO (dx, dy) (MSX2)
+ */
+void basic_dl_copy(int16_t sx, int16_t sy, uint16_t width, uint16_t height,
+                   int16_t dx, int16_t dy);
+
+/**
+ * @brief Record PUT (x, y), buffer, op
+ * Only the buffer address is stored; its contents are read on replay.
+ */
+void basic_dl_put(int16_t x, int16_t y, const uint8_t* buffer, uint8_t op);
+
+/**
+ * @brief Record PUT SPRITE sprite_num, (x, y), color, pattern
+ */
+void basic_dl_sprite(uint8_t sprite_num, int16_t x, int16_t y, uint8_t color, uint8_t pattern);
+
+/**
+ * @brief Replay a display list
+ * The screen mode, clip rectangle (VIEW), color packing and sprite
+ * table are resolved once for the whole list, and each item goes to the
+ * drawing engine directly. The graphic cursor ends where the immediate
+ * calls would leave it. A list may be replayed any number of times and
+ * in any screen mode.
+ * @param dl List recorded with basic_dl_begin()/basic_dl_end()
+ * @param vsync 1 to wait for VBLANK before the first primitive
+ */
+void basic_dl_execute(const uint8_t* dl, uint8_t vsync);
+
 /* === Sprite functions === */
 
 /**
@@ -240,6 +510,28 @@ void basic_sprite_off(uint8_t sprite_num);
  */
 void basic_sprites_off(void);
 
+/* basic_sprite_buffer() modes */
+#define SPRITE_BUF_OFF      0   /* Write attributes straight to VRAM */
+#define SPRITE_BUF_MANUAL   1   /* Keep them in RAM until basic_sprite_flush() */
+#define SPRITE_BUF_VBLANK   2   /* Upload changes from the VBLANK interrupt */
+
+/**
+ * @brief Buffer sprite attributes in a 128-byte RAM copy of the SAT
+ * basic_put_sprite() and basic_sprite_off() then only update RAM, and
+ * the changed bytes go to VRAM in one burst. In sprite mode 2 the
+ * 512-byte color table written by basic_smux_update() is buffered too
+ * and uploaded in the same burst. SPRITE_BUF_VBLANK adds the
+ * upload with basic_timi_add() and falls back to SPRITE_BUF_MANUAL when
+ * no slot is free. Call again after changing the screen mode.
+ * @param mode SPRITE_BUF_OFF, SPRITE_BUF_MANUAL or SPRITE_BUF_VBLANK
+ */
+void basic_sprite_buffer(uint8_t mode);
+
+/**
+ * @brief Upload the changed part of the buffered SAT now
+ */
+void basic_sprite_flush(void);
+
 /**
  * @brief Check sprite collision
  * Equivalent to: SPRITE ON / collision flag
@@ -247,11 +539,52 @@ void basic_sprites_off(void);
  */
 uint8_t basic_sprite_collision(void);
 
+/* === Sprite multiplexer === */
+
+#define SMUX_MAX    64  /* Logical sprites */
+
+/**
+ * @brief Reset the sprite multiplexer and hide all logical sprites
+ */
+void basic_smux_init(void);
+
+/**
+ * @brief Place a logical sprite (shown by the next basic_smux_update())
+ * @param id Logical sprite (0 to SMUX_MAX-1)
+ * @param x X position
+ * @param y Y position
+ * @param color Sprite color (0-15)
+ * @param pattern Pattern number
+ */
+void basic_smux_set(uint8_t id, int16_t x, int16_t y, uint8_t color, uint8_t pattern);
+
+/**
+ * @brief Hide a logical sprite
+ * @param id Logical sprite (0 to SMUX_MAX-1)
+ */
+void basic_smux_hide(uint8_t id);
+
+/**
+ * @brief Assign hardware planes and write the sprite attribute table
+ * Call once per frame. Sprites are sorted by Y; where more than 4
+ * (sprite mode 1) or 8 (sprite mode 2) share a line, detected from the
+ * Y positions or from the 5S flag of the last frame, their plane order
+ * rotates every frame so the dropped sprites flicker instead of
+ * vanishing. Beyond 32 visible sprites a rotating window of 32 is shown.
+ * The table, and in sprite mode 2 the color lines of the planes, go
+ * through the basic_sprite_buffer() shadow when it is on, otherwise
+ * straight to VRAM. Planes are owned by the multiplexer;
+ * do not mix with basic_put_sprite().
+ * @return Number of hardware planes used
+ */
+uint8_t basic_smux_update(void);
+
 /* === COPY commands (MSX2) === */
 
 /**
  * @brief Copy screen area (MSX2)
  * Equivalent to: COPY (x1,y1)-(x2,y2) TO (dx,dy)
+ * Both areas are on the active page (ACPAGE).
  * @param sx Source X
  * @param sy Source Y
  * @param width Width of area
@@ -285,6 +618,33 @@ void basic_copy_page(int16_t sx, int16_t sy, uint16_t width, uint16_t height,
  */
 void basic_set_page(uint8_t display_page, uint8_t active_page);
 
+/**
+ * @brief Start double buffering (SCREEN 5-12)
+ * Shows the front page and directs all drawing to the back page (ACPAGE).
+ * @param front Page to display
+ * @param back Page to draw into
+ */
+void basic_dbuf_init(uint8_t front, uint8_t back);
+
+/**
+ * @brief Show the back page at the next VBLANK and swap the pages
+ * Waits for queued VDP commands first, so the shown page is complete.
+ * Drawing continues on the new back page (the old front page).
+ */
+void basic_dbuf_flip(void);
+
+/**
+ * @brief Clear the back page with HMMV (queued, returns at once)
+ * @param color Fill color
+ */
+void basic_dbuf_clear(uint8_t color);
+
+/**
+ * @brief Copy a background page to the back page with HMMM (queued)
+ * @param src_page Page holding the background
+ */
+void basic_dbuf_restore(uint8_t src_page);
+
 /* === GET/PUT Graphics Block operations === */
 
 /**
@@ -298,6 +658,9 @@ uint16_t basic_get_size(uint16_t width, uint16_t height);
 /**
  * @brief Save screen area to buffer
  * Equivalent to: GET (x1,y1)-(x2,y2), array
+ * Rows are stored packed in the VRAM pixel format (4 bpp SCREEN 5/7,
+ * 2 bpp SCREEN 6, 8 bpp SCREEN 8-12, 1 bpp pattern bits SCREEN 2/4)
+ * and read with direct VRAM streaming. The area is clamped to the screen.
  * @param x1 Left X coordinate
  * @param y1 Top Y coordinate
  * @param x2 Right X coordinate
@@ -310,10 +673,14 @@ uint16_t basic_get(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t* buff
 /**
  * @brief Restore screen area from buffer
  * Equivalent to: PUT (x,y), array, operation
+ * SCREEN 5-12: PSET of a byte-aligned block streams with HMMC, other
+ * operations with LMMC and the matching logical operation.
+ * SCREEN 2/4: pattern bits are combined; the color table is unchanged.
  * @param x Left X coordinate
  * @param y Top Y coordinate
  * @param buffer Buffer containing image data
- * @param op Operation mode: 0=PSET, 1=AND, 2=OR, 3=XOR, 4=PRESET
+ * @param op Operation mode: 0=PSET, 1=AND, 2=OR, 3=XOR, 4=PRESET,
+ *           +8 for the transparent variant (color 0 / 0 bits are skipped)
  */
 void basic_put(int16_t x, int16_t y, const uint8_t* buffer, uint8_t op);
 
@@ -323,6 +690,11 @@ void basic_put(int16_t x, int16_t y, const uint8_t* buffer, uint8_t op);
 #define PUT_OR      2   /* OR operation */
 #define PUT_XOR     3   /* XOR operation */
 #define PUT_PRESET  4   /* Inverted overwrite */
+#define PUT_TPSET   8   /* Transparent overwrite */
+#define PUT_TAND    9   /* Transparent AND */
+#define PUT_TOR     10  /* Transparent OR */
+#define PUT_TXOR    11  /* Transparent XOR */
+#define PUT_TPRESET 12  /* Transparent inverted overwrite */
 
 /**
  * @brief Draw filled circle
@@ -25,6 +25,9 @@
 #include "bmath.h"      /* Named bmath.h to avoid conflict with standard math.h */
 #include "system.h"
 #include "vdp.h"        /* VDP access functions (MSX2+) */
+#include "vram.h"       /* Direct-port VRAM streaming */
+#include "tilemap.h"    /* Tile layer (SCREEN 1/2/4) */
+#include "scroll.h"     /* Hardware scrolling */
 
 /* MSX system type detection */
 #define MSX_TYPE_MSX1     0
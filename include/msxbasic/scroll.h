@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) UO Soft
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file scroll.h
+ * @brief Hardware scrolling for SCREEN 5 and up
+ *
+ * Horizontal scrolling uses the V9958 registers R#26/R#27 (MSX2+) in the
+ * 256-dot modes (SCREEN 5, 8, 10-12). The display wraps around in VRAM,
+ * so only the columns that scroll into view are rewritten, with a narrow
+ * HMMM from a source page.
+ *
+ * Vertical scrolling uses R#23 (MSX2, SCREEN 5-12). The display page is
+ * a 256-line ring; rows scrolling into view are copied from a tall
+ * canvas elsewhere in VRAM (HMMM) or sent from RAM (HMMC). The ring uses
+ * all 256 lines of the display page, so it must not be the page holding
+ * the sprite tables (page 0) while sprites are in use.
+ */
+
+#ifndef MSXBASIC_SCROLL_H
+#define MSXBASIC_SCROLL_H
+
+#include <stdint.h>
+
+/* hscroll_init flags (R#25 bits) */
+#define HSCROLL_MASK    0x02    /* MSK: hide the leftmost 8 dots */
+#define HSCROLL_2PAGE   0x01    /* SP2: scroll over two pages (512 dots) */
+
+/**
+ * @brief Start horizontal scrolling (MSX2+, SCREEN 5/8/10-12)
+ * The source page must hold, at VRAM column (x mod 256), the picture of
+ * world column x for every column that is about to scroll into view
+ * (with HSCROLL_2PAGE: mod 512 over the page pair src_page, src_page+1).
+ * With HSCROLL_MASK, steps of up to 8 dots per frame are tear-free.
+ * @param src_page Page the new columns are copied from
+ * @param flags HSCROLL_MASK and/or HSCROLL_2PAGE
+ */
+void hscroll_init(uint8_t src_page, uint8_t flags);
+
+/**
+ * @brief Scroll to world position x
+ * Copies the newly exposed columns from the source page, waits for
+ * VBLANK and sets R#26/R#27. Any step size is accepted; a step of a
+ * screen or more refills the whole width.
+ * @param x Left edge of the view in world dots
+ */
+void hscroll_set(uint16_t x);
+
+/**
+ * @brief Stop horizontal scrolling and reset R#25-R#27
+ */
+void hscroll_off(void);
+
+/**
+ * @brief Row provider for vscroll_init_ram()
+ * @param y World line
+ * @return Packed pixel bytes of the line (VRAM format, full width)
+ */
+typedef const uint8_t* (*VscrollRowFn)(uint16_t y);
+
+/**
+ * @brief Start vertical scrolling over a tall canvas in VRAM (MSX2)
+ * World line y is taken from VRAM line (src_line + y), wrapping at the
+ * end of VRAM (1024 lines in SCREEN 5/6, 512 in SCREEN 7-12), so the
+ * canvas may span several pages.
+ * @param src_line VRAM line of world line 0
+ */
+void vscroll_init(uint16_t src_line);
+
+/**
+ * @brief Start vertical scrolling with rows supplied from RAM (MSX2)
+ * @param row Called once for every line that scrolls into view
+ */
+void vscroll_init_ram(VscrollRowFn row);
+
+/**
+ * @brief Scroll to world line y
+ * Fills only the lines that scroll into view, waits for VBLANK and sets
+ * R#23. The first call after init fills the whole screen.
+ * @param y Top of the view in world lines
+ */
+void vscroll_set(uint16_t y);
+
+/**
+ * @brief Stop vertical scrolling and reset R#23
+ */
+void vscroll_off(void);
+
+#endif /* MSXBASIC_SCROLL_H */
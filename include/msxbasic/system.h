@@ -273,15 +273,35 @@ void basic_vram_read(uint8_t* dest, uint16_t src, uint16_t count);
 
 /**
  * @brief Wait for vertical blank
+ * Queued VDP commands are completed first (MSX2).
  */
 void basic_wait_vblank(void);
 
 /**
  * @brief Wait for specified number of frames
+ * Queued VDP commands are completed first (MSX2).
  * @param frames Number of frames to wait
  */
 void basic_wait_frames(uint16_t frames);
 
+/**
+ * @brief Add a routine to the VBLANK interrupt (H.TIMI)
+ * All library hooks share one H.TIMI patch, so routines may be added
+ * and removed in any order; the previous hook runs after them. A routine
+ * runs with interrupts disabled, may use all registers and returns with
+ * RET. Up to 4 routines; adding one twice has no effect.
+ * @param fn Routine to call every VBLANK
+ * @return 1 on success, 0 if all slots are in use
+ */
+uint8_t basic_timi_add(void (*fn)(void));
+
+/**
+ * @brief Remove a routine added with basic_timi_add()
+ * H.TIMI is restored when the last routine is removed.
+ * @param fn Routine to remove
+ */
+void basic_timi_remove(void (*fn)(void));
+
 /**
  * @brief Call BIOS routine
  * @param address BIOS routine address
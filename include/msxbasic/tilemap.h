@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) UO Soft
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file tilemap.h
+ * @brief Tile layer for SCREEN 1/2/4 name tables
+ *
+ * A map in RAM or ROM, larger than the screen, is viewed through a 32x24
+ * window. tile_scroll() copies the window into a 768-byte shadow name
+ * table with one block copy per row; tile_upload() sends the rows that
+ * changed to VRAM, starting at VBLANK.
+ *
+ * With page flipping the shadow is written to a second name table while
+ * the first one is shown, and R#2 is switched at VBLANK. The second table
+ * is at 0x1C00 in SCREEN 1/2 and at 0x5800 in SCREEN 4 (MSX2), where
+ * 0x1C00-0x1FFF holds the sprite tables. Text output through the BIOS
+ * keeps using the name table set by SCREEN.
+ */
+
+#ifndef MSXBASIC_TILEMAP_H
+#define MSXBASIC_TILEMAP_H
+
+#include <stdint.h>
+
+#define TILE_COLS   32      /* Window width in tiles */
+#define TILE_ROWS   24      /* Window height in tiles */
+
+/**
+ * @brief Attach a map and start at its top-left corner
+ * Call after SCREEN 1, 2 or 4 has been set.
+ * @param map Tile numbers, row by row
+ * @param width Map width in tiles (at least 32)
+ * @param height Map height in tiles (at least 24)
+ * @param flip 1 to alternate two name tables via R#2
+ */
+void tile_init(const uint8_t* map, uint16_t width, uint16_t height, uint8_t flip);
+
+/**
+ * @brief Move the window and copy it into the shadow name table
+ * The position is clamped so that the window stays inside the map.
+ * Call again after changing the map to refresh the shadow.
+ * @param x Left column of the window in the map
+ * @param y Top row of the window in the map
+ */
+void tile_scroll(uint16_t x, uint16_t y);
+
+/**
+ * @brief Overwrite one tile of the shadow (e.g. a status line)
+ * @param x Screen column (0-31)
+ * @param y Screen row (0-23)
+ * @param tile Tile number
+ */
+void tile_put(uint8_t x, uint8_t y, uint8_t tile);
+
+/**
+ * @brief Show the shadow name table
+ * Only rows changed by tile_scroll()/tile_put() since the table was last
+ * written are sent. Without flipping, the rows are written top-down from
+ * VBLANK. A full table (after tile_scroll) takes about 6 ms, longer than
+ * VBLANK; it stays ahead of the beam only because a 32-byte row is sent
+ * faster than 8 lines are displayed, so a slow interrupt handler (PLAY,
+ * other hooks) can still make the lower rows tear. With flipping, writes
+ * the hidden table first and switches R#2 at VBLANK, so the picture
+ * never shows a half-updated table.
+ */
+void tile_upload(void);
+
+#endif /* MSXBASIC_TILEMAP_H */
@@ -51,6 +51,7 @@
 #define VDP_STATUS_5S   0x40    /* 5th sprite flag */
 #define VDP_STATUS_C    0x20    /* Sprite collision */
 #define VDP_STATUS_CE   0x01    /* Command executing (MSX2) */
+#define VDP_STATUS_BD   0x10    /* Border color detected by SRCH (S#2, MSX2) */
 
 /* MSX2 VDP commands */
 #define VDP_CMD_HMMC    0xF0    /* CPU -> VRAM (high speed) */
@@ -67,6 +68,11 @@
 #define VDP_CMD_POINT   0x40    /* Get pixel */
 #define VDP_CMD_STOP    0x00    /* Stop command */
 
+/* SRCH command arguments (ARG register) */
+#define VDP_SRCH_RIGHT  0x00    /* Search towards larger X */
+#define VDP_SRCH_LEFT   0x04    /* Search towards smaller X (DIX) */
+#define VDP_SRCH_NE     0x02    /* Stop at the first pixel NOT of the color (EQ) */
+
 /* Logical operations for VDP commands */
 #define VDP_LOG_IMP     0x00    /* DC = SC */
 #define VDP_LOG_AND     0x01    /* DC = SC AND DC */
@@ -79,6 +85,26 @@
 #define VDP_LOG_TXOR    0x0B    /* Transparent XOR */
 #define VDP_LOG_TNOT    0x0C    /* Transparent NOT */
 
+/* VDP command queue */
+#define VDP_QUEUE_SIZE  16      /* Ring entries (power of 2, holds SIZE-1) */
+
+/**
+ * @brief VDP command descriptor
+ * Laid out like the command registers R#32-R#46 (16-bit fields are
+ * little-endian low/high register pairs).
+ */
+typedef struct {
+    uint16_t sx;        /* R#32-R#33 Source X */
+    uint16_t sy;        /* R#34-R#35 Source Y */
+    uint16_t dx;        /* R#36-R#37 Destination X */
+    uint16_t dy;        /* R#38-R#39 Destination Y */
+    uint16_t nx;        /* R#40-R#41 Width / long side */
+    uint16_t ny;        /* R#42-R#43 Height / short side */
+    uint8_t clr;        /* R#44 Color */
+    uint8_t arg;        /* R#45 Direction / major axis */
+    uint8_t cmd;        /* R#46 Command | logical operation */
+} VdpCmd;
+
 /**
  * @brief Write to VDP register
  * @param reg Register number
@@ -95,17 +121,82 @@ uint8_t vdp_read_status(uint8_t reg);
 
 /**
  * @brief Wait for VDP command to complete
+ * Only waits for the running command; use vdp_flush() to drain the queue.
  */
 void vdp_wait_cmd(void);
 
+/**
+ * @brief Queue a VDP command (MSX2)
+ * Returns at once: the command is issued now if the VDP is idle, otherwise
+ * by a later vdp_pump()/queue call, the VBLANK hook, or before the
+ * library blocks (basic_wait_vblank, basic_wait_key...). Blocks only when
+ * the queue is full. Issuing sets R#17 once and sends R#32-R#46 in one
+ * OTIR burst to port 0x9B.
+ * @param cmd Command descriptor (copied)
+ * @return Fence for this command (see vdp_fence_done)
+ */
+uint16_t vdp_submit(const VdpCmd* cmd);
+
+/**
+ * @brief Queue a VDP command that leaves SX/SY (R#32-R#35) unchanged
+ * Only R#36-R#46 are sent. Use for commands that do not read SX/SY, or
+ * when the previous command already loaded the same source.
+ * @param cmd Command descriptor (copied; sx/sy are ignored)
+ * @return Fence for this command (see vdp_fence_done)
+ */
+uint16_t vdp_submit_dx(const VdpCmd* cmd);
+
+/**
+ * @brief Issue the next queued command if the VDP is idle
+ * @return Number of commands still queued
+ */
+uint8_t vdp_pump(void);
+
+/**
+ * @brief Issue all queued commands and wait until the VDP is idle
+ * Call before reading or writing VRAM that queued commands may touch.
+ */
+void vdp_flush(void);
+
+/**
+ * @brief Fence for the most recently submitted command
+ * @return Fence value
+ */
+uint16_t vdp_fence(void);
+
+/**
+ * @brief Check whether a fenced command (and all before it) has completed
+ * @param fence Value from vdp_submit() or vdp_fence()
+ * @return 1 if completed
+ */
+uint8_t vdp_fence_done(uint16_t fence);
+
+/**
+ * @brief Wait until a fenced command has completed
+ * @param fence Value from vdp_submit() or vdp_fence()
+ */
+void vdp_fence_wait(uint16_t fence);
+
+/**
+ * @brief Drain the command queue from the VBLANK interrupt (H.TIMI)
+ * Added with basic_timi_add(), so it combines with other library hooks
+ * in any order. The hook leaves the VDP alone while a transfer started
+ * through the vram_* helpers is open; other port access is not seen
+ * (see vram_open).
+ * @param enable 1 to install, 0 to remove
+ */
+void vdp_queue_hook(uint8_t enable);
+
 /**
  * @brief Set VRAM write address (MSX2, 128KB VRAM)
+ * End the transfer with vram_close().
  * @param addr 17-bit VRAM address
  */
 void vdp_set_write_addr(uint32_t addr);
 
 /**
  * @brief Set VRAM read address (MSX2, 128KB VRAM)
+ * End the transfer with vram_close().
  * @param addr 17-bit VRAM address
  */
 void vdp_set_read_addr(uint32_t addr);
@@ -123,7 +214,7 @@ void vdp_write_vram(uint8_t value);
 uint8_t vdp_read_vram(void);
 
 /**
- * @brief MSX2 VDP PSET command
+ * @brief MSX2 VDP PSET command (queued)
  * @param x X coordinate
  * @param y Y coordinate
  * @param color Color
@@ -132,7 +223,7 @@ uint8_t vdp_read_vram(void);
 void vdp_pset(uint16_t x, uint16_t y, uint8_t color, uint8_t op);
 
 /**
- * @brief MSX2 VDP LINE command
+ * @brief MSX2 VDP LINE command (queued)
  * @param x1 Start X
  * @param y1 Start Y
  * @param x2 End X
@@ -143,7 +234,7 @@ void vdp_pset(uint16_t x, uint16_t y, uint8_t color, uint8_t op);
 void vdp_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color, uint8_t op);
 
 /**
- * @brief MSX2 VDP HMMV command (fill rectangle)
+ * @brief MSX2 VDP LMMV command (fill rectangle, queued)
  * @param x X coordinate
  * @param y Y coordinate
  * @param width Width
@@ -153,7 +244,7 @@ void vdp_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color,
 void vdp_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t color);
 
 /**
- * @brief MSX2 VDP HMMM command (copy rectangle)
+ * @brief MSX2 VDP HMMM command (copy rectangle, queued)
  * @param sx Source X
  * @param sy Source Y
  * @param dx Destination X
@@ -163,6 +254,74 @@ void vdp_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t c
  */
 void vdp_copy(uint16_t sx, uint16_t sy, uint16_t dx, uint16_t dy, uint16_t width, uint16_t height);
 
+/**
+ * @brief Scroll a rectangular band vertically (MSX2, queued)
+ * Uses YMMM when the band touches the left or right edge of the screen
+ * (x and the width byte-aligned), HMMM for other byte-aligned bands and
+ * the slower LMMM when x or the width is not byte-aligned (SCREEN 5-7),
+ * so pixels beside the band never move. The exposed rows are
+ * filled with color (LMMV), or left for the caller when color < 0.
+ * @param x Left X
+ * @param y Top Y (VDP Y coordinate, including page offset)
+ * @param width Width
+ * @param height Height
+ * @param lines Rows to move: negative moves up, positive moves down
+ * @param color Fill color for the exposed rows, or -1 to leave them
+ * @return VDP Y of the first exposed row
+ */
+uint16_t vdp_scroll_region(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                           int16_t lines, int16_t color);
+
+/**
+ * @brief Start MSX2 VDP HMMC/LMMC (CPU -> VRAM) transfer
+ * The first byte is passed here; the rest follow with vdp_xfer_send().
+ * @param x Destination X
+ * @param y Destination Y (VDP Y coordinate, including page offset)
+ * @param width Width in pixels
+ * @param height Height in pixels
+ * @param first First data byte (HMMC) or pixel (LMMC)
+ * @param cmd VDP_CMD_HMMC, or VDP_CMD_LMMC | VDP_LOG_*
+ */
+void vdp_xfer_start(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                    uint8_t first, uint8_t cmd);
+
+/**
+ * @brief Send data to a running HMMC/LMMC transfer
+ * May be called repeatedly with consecutive chunks. Interrupts are
+ * disabled while the chunk is sent.
+ * @param src Data bytes (HMMC) or one pixel per byte (LMMC)
+ * @param count Number of bytes
+ */
+void vdp_xfer_send(const uint8_t* src, uint16_t count);
+
+/**
+ * @brief Start MSX2 VDP SRCH command without waiting for the result
+ * Scans row y from x (inclusive) until a pixel of the given color is
+ * found, or until a pixel of another color with VDP_SRCH_NE. The CPU is
+ * free until vdp_search_result() is called.
+ * @param x Start X
+ * @param y Row (VDP Y coordinate, including page offset)
+ * @param color Color to compare against
+ * @param arg VDP_SRCH_RIGHT or VDP_SRCH_LEFT, optionally | VDP_SRCH_NE
+ */
+void vdp_search_start(uint16_t x, uint16_t y, uint8_t color, uint8_t arg);
+
+/**
+ * @brief Wait for SRCH to complete and return its result
+ * @return X where the search stopped, or -1 if the edge of the screen was reached
+ */
+int16_t vdp_search_result(void);
+
+/**
+ * @brief MSX2 VDP SRCH command (blocking)
+ * @param x Start X
+ * @param y Row (VDP Y coordinate, including page offset)
+ * @param color Color to compare against
+ * @param arg VDP_SRCH_RIGHT or VDP_SRCH_LEFT, optionally | VDP_SRCH_NE
+ * @return X where the search stopped, or -1 if not found
+ */
+int16_t vdp_search(uint16_t x, uint16_t y, uint8_t color, uint8_t arg);
+
 /**
  * @brief Set palette color (MSX2)
  * @param index Palette index (0-15)
@@ -0,0 +1,168 @@
+/*
+ * Copyright (c) UO Soft
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file vram.h
+ * @brief Direct-port VRAM streaming (ports 0x98/0x99)
+ *
+ * Sets the VRAM address once and streams bytes with OUTI/INI
+ * auto-increment, without going through the BIOS trampoline.
+ * Transfer loops are paced for the TMS9918 (29 T-states per byte),
+ * so they are safe on every MSX generation.
+ *
+ * On MSX2 and later the address setup also writes R#14 (A14-A16).
+ * On MSX1 R#14 is never touched; keep addresses below 0x4000.
+ */
+
+#ifndef MSXBASIC_VRAM_H
+#define MSXBASIC_VRAM_H
+
+#include <stdint.h>
+
+/**
+ * @brief Nonzero while a direct VRAM transfer may be in progress
+ * Set by every address setup and cleared when the transfer ends. The
+ * single-call helpers (vram_peek/vram_poke and their _ex forms,
+ * vram_ldirvm, vram_ldirmv, vram_filvrm) clear it themselves; a stream
+ * started with vram_set_write()/vram_set_read() ends with vram_close().
+ * Interrupt code must not touch port 0x99 while it is set, because a
+ * register write would overwrite the VRAM address. Only these helpers
+ * (and the vdp_* and basic_vpeek/basic_vpoke calls built on them) set it;
+ * BIOS calls through the library trampoline run with H.TIMI disabled.
+ * Code that programs ports 0x98/0x99 itself or calls the BIOS directly
+ * is not protected and must disable interrupts while a VBLANK routine
+ * (vdp_queue_hook, SPRITE_BUF_VBLANK) is installed.
+ */
+extern uint8_t vram_open;
+
+/**
+ * @brief Last value written to R#14 by an address setup (MSX2)
+ * Interrupt code that sets its own VRAM address restores R#14 from it.
+ */
+extern uint8_t vram_r14;
+
+/**
+ * @brief Select MSX1 or MSX2 address handling
+ * Called by basic_init(); not normally needed by programs.
+ * @param ext 1 if the VDP has 128KB VRAM and R#14 (MSX2 or later)
+ */
+void vram_init(uint8_t ext);
+
+/**
+ * @brief Set VRAM write address (16-bit)
+ * @param addr VRAM address (bits 14-15 go to R#14 on MSX2)
+ */
+void vram_set_write(uint16_t addr);
+
+/**
+ * @brief Set VRAM read address (16-bit)
+ * @param addr VRAM address (bits 14-15 go to R#14 on MSX2)
+ */
+void vram_set_read(uint16_t addr);
+
+/**
+ * @brief Set VRAM write address (17-bit, MSX2)
+ * @param addr VRAM address (0x00000-0x1FFFF)
+ */
+void vram_set_write_ex(uint32_t addr);
+
+/**
+ * @brief Set VRAM read address (17-bit, MSX2)
+ * @param addr VRAM address (0x00000-0x1FFFF)
+ */
+void vram_set_read_ex(uint32_t addr);
+
+/**
+ * @brief End a stream started with vram_set_write()/vram_set_read()
+ * Clears vram_open so interrupt hooks may use the VDP again.
+ */
+void vram_close(void);
+
+/**
+ * @brief Stream bytes to VRAM at the current write address
+ * @param src Source buffer in RAM
+ * @param count Number of bytes
+ */
+void vram_write(const uint8_t* src, uint16_t count);
+
+/**
+ * @brief Stream bytes from VRAM at the current read address
+ * @param dest Destination buffer in RAM
+ * @param count Number of bytes
+ */
+void vram_read(uint8_t* dest, uint16_t count);
+
+/**
+ * @brief Stream one value to VRAM at the current write address
+ * @param value Byte to repeat
+ * @param count Number of bytes
+ */
+void vram_fill(uint8_t value, uint16_t count);
+
+/**
+ * @brief Write one byte at the current write address
+ * @param value Byte to write
+ */
+void vram_put(uint8_t value);
+
+/**
+ * @brief Read one byte at the current read address
+ * @return Byte read
+ */
+uint8_t vram_get(void);
+
+/**
+ * @brief Read a single VRAM byte (16-bit address)
+ * @param addr VRAM address
+ * @return Byte read
+ */
+uint8_t vram_peek(uint16_t addr);
+
+/**
+ * @brief Write a single VRAM byte (16-bit address)
+ * @param addr VRAM address
+ * @param value Byte to write
+ */
+void vram_poke(uint16_t addr, uint8_t value);
+
+/**
+ * @brief Read a single VRAM byte (17-bit address, MSX2)
+ * @param addr VRAM address
+ * @return Byte read
+ */
+uint8_t vram_peek_ex(uint32_t addr);
+
+/**
+ * @brief Write a single VRAM byte (17-bit address, MSX2)
+ * @param addr VRAM address
+ * @param value Byte to write
+ */
+void vram_poke_ex(uint32_t addr, uint8_t value);
+
+/**
+ * @brief Copy RAM to VRAM (replacement for BIOS LDIRVM)
+ * @param dest VRAM destination address
+ * @param src RAM source
+ * @param count Number of bytes
+ */
+void vram_ldirvm(uint16_t dest, const uint8_t* src, uint16_t count);
+
+/**
+ * @brief Copy VRAM to RAM (replacement for BIOS LDIRMV)
+ * @param dest RAM destination
+ * @param src VRAM source address
+ * @param count Number of bytes
+ */
+void vram_ldirmv(uint8_t* dest, uint16_t src, uint16_t count);
+
+/**
+ * @brief Fill VRAM block (replacement for BIOS FILVRM)
+ * @param addr VRAM start address
+ * @param count Number of bytes
+ * @param value Fill value
+ */
+void vram_filvrm(uint16_t addr, uint16_t count, uint8_t value);
+
+#endif /* MSXBASIC_VRAM_H */
@@ -14,6 +14,7 @@
 #include <msx.h>
 #include "../../include/msxbasic/graphics.h"
 #include "../../include/msxbasic/vdp.h"
+#include "../../include/msxbasic/vram.h"
 
 /* MSX System Variables */
 #define GRPACX      0xFCB7
@@ -24,6 +25,7 @@
 #define BAKCLR      0xF3EA
 #define MSXVER      0x002D
 #define ACPAGE      0xFAF6  /* Active page (MSX2) */
+#define JIFFY       0xFC9E  /* Counted up by the VBLANK interrupt */
 
 /* Helper macros */
 #define sys_write8(addr, val)  (*(volatile uint8_t*)(addr) = (val))
@@ -33,6 +35,7 @@
 
 /* Use cached MSX version from system.c */
 extern uint8_t basic_is_msx2(void);
+extern void basic_wait_vblank(void);
 
 static uint8_t is_msx2(void) {
     return basic_is_msx2();
@@ -46,18 +49,10 @@ static uint8_t pack_color_screen6(uint8_t color) {
     return (color << 6) | (color << 4) | (color << 2) | color;
 }
 
-/* Check if current screen mode uses MSX2 VDP commands */
-static uint8_t is_msx2_gfx_mode(void) {
-    uint8_t mode = sys_read8(SCRMOD);
-    return (mode >= 5 && mode <= 12);
-}
-
 /* BIOS wrappers - sccz80 pushes parameters left-to-right */
 #asm
 
 PUBLIC _gfx_clrspr
-PUBLIC _gfx_rdvrm
-PUBLIC _gfx_wrtvrm
 
 _gfx_clrspr:
     ld hl, 0x0069
@@ -65,107 +60,415 @@ _gfx_clrspr:
     call 0xC000     ; CLRSPR via trampoline
     ret
 
-; uint8_t gfx_rdvrm(uint16_t addr)
-; Stack: [ret_addr][addr]
-_gfx_rdvrm:
-    ld hl, 2
-    add hl, sp
-    ld e, (hl)      ; addr low
-    inc hl
-    ld d, (hl)      ; addr high
-    ex de, hl       ; HL = addr
-    push hl
-    ld hl, 0x004A
-    ld (0xC02C), hl
-    pop hl
-    call 0xC000     ; RDVRM via trampoline
-    ld l, a         ; return value in L
-    ret
-
-; void gfx_wrtvrm(uint16_t addr, uint8_t val)
-; Stack: [ret_addr][val][addr]
-_gfx_wrtvrm:
-    ld hl, 2
-    add hl, sp
-    ld a, (hl)      ; val at SP+2
-    inc hl
-    inc hl          ; skip high byte of val
-    ld e, (hl)      ; addr low at SP+4
-    inc hl
-    ld d, (hl)      ; addr high at SP+5
-    ex de, hl       ; HL = addr
-    push hl
-    push af
-    ld hl, 0x004D
-    ld (0xC02C), hl
-    pop af
-    pop hl
-    call 0xC000     ; WRTVRM via trampoline
-    ret
-
 #endasm
 
 extern void gfx_clrspr(void);
-extern uint8_t gfx_rdvrm(uint16_t addr);
-extern void gfx_wrtvrm(uint16_t addr, uint8_t val);
 
-/* Static variables for extended VRAM access */
-static uint16_t vram_addr;
-static uint8_t vram_val;
+/* Line offset of a page in SCREEN 5-12 */
+static uint16_t page_y(uint8_t mode, uint8_t page) {
+    /* SCREEN 5/6: 4 pages, SCREEN 7/8 and 10-12: 2 pages, 256 lines each */
+    if (mode == 5 || mode == 6) {
+        return (uint16_t)(page & 3) << 8;
+    }
+    return (uint16_t)(page & 1) << 8;
+}
 
-/* MSX2 extended VRAM write (for addresses >= 0x4000) */
-static void gfx_wrtvrm_ext(uint16_t addr, uint8_t val) {
-    uint8_t mode = sys_read8(SCRMOD);
+/* Line offset of the active page (ACPAGE) in SCREEN 5-12 */
+static uint16_t acpage_y(uint8_t mode) {
+    return page_y(mode, sys_read8(ACPAGE));
+}
 
-    /* For MSX1 modes or addresses < 0x4000, use standard BIOS */
-    if (mode < 5 || addr < 0x4000) {
-        gfx_wrtvrm(addr, val);
-        return;
+/* Set the 17-bit VRAM read address of bitmap pixel (x, y) on the active page */
+static void bitmap_set_read(int16_t x, int16_t y, uint8_t mode) {
+    uint16_t line = (uint16_t)y + acpage_y(mode);
+    uint16_t lo;
+    uint8_t hi;
+
+    if (mode == 5 || mode == 6) {
+        /* 128 bytes per line: 2 (SCREEN 5) or 4 (SCREEN 6) pixels per byte */
+        hi = (uint8_t)(line >> 9);
+        lo = (line << 7) + ((mode == 5) ? (x >> 1) : (x >> 2));
+    } else {
+        /* 256 bytes per line: 2 (SCREEN 7) or 1 (SCREEN 8-12) pixels per byte */
+        hi = (uint8_t)(line >> 8);
+        lo = (line << 8) + ((mode == 7) ? (x >> 1) : x);
     }
 
-    /* Store to static variables for assembly access */
-    vram_addr = addr;
-    vram_val = val;
+    vram_set_read_ex(((uint32_t)hi << 16) | lo);
+}
 
-    /* MSX2 extended VRAM access via direct VDP port */
-    #asm
-        di
-        ; Set R#14 for extended address bits (bits 16-14 of address)
-        ld hl, (_vram_addr + 1)  ; High byte of addr
-        ld a, l
-        rlca
-        rlca
-        and 0x07
-        out (0x99), a
-        ld a, 0x80 + 14
-        out (0x99), a
-
-        ; Set VRAM address for write
-        ld hl, (_vram_addr)
-        ld a, l             ; Low byte
-        out (0x99), a
-        ld a, h             ; High byte
-        and 0x3F
-        or 0x40             ; Set write bit
-        out (0x99), a
-
-        ; Write data
-        ld a, (_vram_val)
-        out (0x98), a
-
-        ; Reset R#14 to 0
-        xor a
-        out (0x99), a
-        ld a, 0x80 + 14
-        out (0x99), a
-        ei
-    #endasm
+/* Extract the color of pixel x from its bitmap VRAM byte */
+static uint8_t bitmap_pixel(uint8_t b, int16_t x, uint8_t mode) {
+    switch (mode) {
+        case 5:
+        case 7:
+            return (x & 1) ? (b & 0x0F) : (b >> 4);
+        case 6:
+            return (b >> ((3 - (x & 3)) << 1)) & 0x03;
+        default:
+            return b;
+    }
+}
+
+/* log2 of pixels per VRAM byte in SCREEN 5-12 */
+static uint8_t bitmap_ppb_shift(uint8_t mode) {
+    if (mode == 6) return 2;
+    if (mode == 5 || mode == 7) return 1;
+    return 0;
 }
 
 /* SCREEN 2 VRAM layout */
 #define SCR2_PATTERN_BASE   0x0000
 #define SCR2_COLOR_BASE     0x2000
 
+/* === SCREEN 2 RAM shadow ===
+ * With basic_shadow() the pattern and color bytes of some bands live in
+ * RAM. The SCREEN 2/4 engines read and write them through scr2_peek(),
+ * scr2_poke() and scr2_run()/scr2_merge(), which mark the touched 8x8
+ * cells in a 768-bit map; basic_flush() uploads the marked cells. */
+
+static uint8_t* shadow_buf;         /* NULL: draw straight to VRAM */
+static uint16_t shadow_lo;          /* First table offset in RAM */
+static uint16_t shadow_hi;          /* End of the shadowed offsets */
+static uint16_t shadow_size;        /* Bytes per table in RAM */
+static uint8_t shadow_dirty[96];    /* One bit per 8x8 cell */
+
+/* RAM byte of VRAM address addr (pattern or color table), or NULL */
+static uint8_t* shadow_ptr(uint16_t addr) {
+    uint16_t off = addr & 0x1FFF;
+
+    if (!shadow_buf || off < shadow_lo || off >= shadow_hi) return 0;
+    return shadow_buf + (off - shadow_lo) + ((addr & 0x2000) ? shadow_size : 0);
+}
+
+/* Mark the cell holding VRAM address addr */
+static void shadow_mark(uint16_t addr) {
+    uint16_t cell = (addr & 0x1FFF) >> 3;
+
+    shadow_dirty[cell >> 3] |= 1 << (cell & 7);
+}
+
+static uint8_t scr2_peek(uint16_t addr) {
+    uint8_t* p = shadow_ptr(addr);
+
+    return p ? *p : vram_peek(addr);
+}
+
+static void scr2_poke(uint16_t addr, uint8_t value) {
+    uint8_t* p = shadow_ptr(addr);
+
+    if (p) {
+        *p = value;
+        shadow_mark(addr);
+    } else {
+        vram_poke(addr, value);
+    }
+}
+
+void basic_shadow(uint8_t* buf, uint8_t first_band, uint8_t bands) {
+    uint8_t i;
+
+    basic_shadow_off();
+    if (!buf || first_band > 2 || bands == 0) return;
+    if (bands > 3 - first_band) bands = 3 - first_band;
+
+    shadow_lo = (uint16_t)first_band << 11;
+    shadow_size = (uint16_t)bands << 11;
+    shadow_hi = shadow_lo + shadow_size;
+    for (i = 0; i < sizeof(shadow_dirty); i++) shadow_dirty[i] = 0;
+
+    /* Start from what is on the screen */
+    vram_ldirmv(buf, SCR2_PATTERN_BASE + shadow_lo, shadow_size);
+    vram_ldirmv(buf + shadow_size, SCR2_COLOR_BASE + shadow_lo, shadow_size);
+    shadow_buf = buf;
+}
+
+void basic_shadow_off(void) {
+    basic_flush();
+    shadow_buf = 0;
+}
+
+void basic_shadow_clear(void) {
+    uint16_t i;
+
+    if (!shadow_buf) return;
+    for (i = 0; i < shadow_size; i++) shadow_buf[i] = 0;
+    for (i = shadow_lo >> 6; i < (shadow_hi >> 6); i++) shadow_dirty[i] = 0xFF;
+}
+
+void basic_flush(void) {
+    uint16_t row, cell, first;
+    uint8_t* d;
+    uint8_t c, n;
+
+    if (!shadow_buf) return;
+
+    /* Upload each run of dirty cells on a character row with two streams */
+    for (row = shadow_lo >> 8; row < (shadow_hi >> 8); row++) {
+        d = &shadow_dirty[row << 2];
+        if (!(d[0] | d[1] | d[2] | d[3])) continue;
+
+        c = 0;
+        while (c < 32) {
+            if (!(d[c >> 3] & (1 << (c & 7)))) {
+                c++;
+                continue;
+            }
+            n = c;
+            while (c < 32 && (d[c >> 3] & (1 << (c & 7)))) c++;
+
+            cell = (row << 5) + n;
+            first = (cell << 3) - shadow_lo;
+            vram_ldirvm(SCR2_PATTERN_BASE + (cell << 3), shadow_buf + first, (uint16_t)(c - n) << 3);
+            vram_ldirvm(SCR2_COLOR_BASE + (cell << 3), shadow_buf + shadow_size + first,
+                        (uint16_t)(c - n) << 3);
+        }
+        d[0] = d[1] = d[2] = d[3] = 0;
+    }
+}
+
+/* === Dirty rectangles (SCREEN 5-12) ===
+ * While tracking is on, every primitive adds the bounding box of what it
+ * drew (after clipping). The screen is split into bands of 32 lines with
+ * one bounding box each, so adding is a few compares per band and the
+ * restore issues at most one HMMM per band from the background page. */
+
+#define DIRTY_BANDS 8           /* 256 lines / 32 */
+
+static uint8_t dirty_on;
+static uint8_t dirty_page;      /* Background page */
+static int16_t dirty_x1[DIRTY_BANDS], dirty_x2[DIRTY_BANDS];
+static uint8_t dirty_y1[DIRTY_BANDS], dirty_y2[DIRTY_BANDS];
+
+void basic_dirty_clear(void) {
+    uint8_t b;
+
+    for (b = 0; b < DIRTY_BANDS; b++) {
+        dirty_x1[b] = 32767;    /* Empty: x1 > x2 */
+        dirty_x2[b] = -1;
+    }
+}
+
+/* Merge (x1,y1)-(x2,y2) in page coordinates into the band boxes */
+static void dirty_add(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    int16_t tmp;
+    uint8_t b, b2, top, bottom;
+
+    if (x1 > x2) { tmp = x1; x1 = x2; x2 = tmp; }
+    if (y1 > y2) { tmp = y1; y1 = y2; y2 = tmp; }
+    if (x2 < 0 || y2 < 0 || y1 > 255) return;
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (y2 > 255) y2 = 255;
+
+    b2 = (uint8_t)y2 >> 5;
+    for (b = (uint8_t)y1 >> 5; b <= b2; b++) {
+        top = (uint8_t)(b << 5);
+        bottom = top + 31;
+        if ((uint8_t)y1 > top) top = (uint8_t)y1;
+        if ((uint8_t)y2 < bottom) bottom = (uint8_t)y2;
+
+        if (dirty_x1[b] > dirty_x2[b]) {
+            dirty_x1[b] = x1;
+            dirty_x2[b] = x2;
+            dirty_y1[b] = top;
+            dirty_y2[b] = bottom;
+            continue;
+        }
+        if (x1 < dirty_x1[b]) dirty_x1[b] = x1;
+        if (x2 > dirty_x2[b]) dirty_x2[b] = x2;
+        if (top < dirty_y1[b]) dirty_y1[b] = top;
+        if (bottom > dirty_y2[b]) dirty_y2[b] = bottom;
+    }
+}
+
+void basic_dirty_track(uint8_t bg_page) {
+    dirty_page = bg_page;
+    dirty_on = 1;
+    basic_dirty_clear();
+}
+
+void basic_dirty_stop(void) {
+    dirty_on = 0;
+}
+
+void basic_dirty_add(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    if (dirty_on) dirty_add(x1, y1, x2, y2);
+}
+
+void basic_dirty_restore(void) {
+    uint8_t mode = sys_read8(SCRMOD);
+    uint8_t mask, b;
+    int16_t x1, x2;
+    uint8_t y1, y2;
+    VdpCmd c;
+
+    if (!dirty_on) return;
+
+    if (mode >= 5 && mode <= 12) {
+        /* HMMM moves whole bytes: widen to byte boundaries */
+        mask = (1 << bitmap_ppb_shift(mode)) - 1;
+
+        c.clr = 0;
+        c.arg = 0;          /* Pages do not overlap */
+        c.cmd = VDP_CMD_HMMM;
+
+        for (b = 0; b < DIRTY_BANDS; b++) {
+            if (dirty_x1[b] > dirty_x2[b]) continue;
+            x1 = dirty_x1[b] & ~(int16_t)mask;
+            x2 = dirty_x2[b] | mask;
+            y1 = dirty_y1[b];
+            y2 = dirty_y2[b];
+
+            /* Join following bands with the same columns that touch this one */
+            while (b + 1 < DIRTY_BANDS && y2 == (uint8_t)(((b + 1) << 5) - 1) &&
+                   dirty_y1[b + 1] == y2 + 1 &&
+                   dirty_x1[b + 1] == dirty_x1[b] && dirty_x2[b + 1] == dirty_x2[b]) {
+                b++;
+                y2 = dirty_y2[b];
+            }
+
+            c.sx = (uint16_t)x1;
+            c.sy = page_y(mode, dirty_page) + y1;
+            c.dx = (uint16_t)x1;
+            c.dy = acpage_y(mode) + y1;
+            c.nx = (uint16_t)(x2 - x1 + 1);
+            c.ny = (uint16_t)(y2 - y1 + 1);
+            vdp_submit(&c);
+        }
+    }
+
+    basic_dirty_clear();
+}
+
+/* === Viewport and clipping ===
+ * basic_view() sets the viewport in screen coordinates. Primitives clip
+ * against clip_x1..clip_y2, the viewport intersected with the screen of
+ * the current mode; it is recomputed only when the mode changes.
+ * Lines use Cohen-Sutherland against the clip rectangle (inclusive bounds). */
+
+#define CLIP_LEFT   0x01
+#define CLIP_RIGHT  0x02
+#define CLIP_TOP    0x04
+#define CLIP_BOTTOM 0x08
+
+static int16_t view_x1 = 0, view_y1 = 0, view_x2 = 32767, view_y2 = 32767;
+static int16_t clip_x1, clip_y1, clip_x2, clip_y2;
+static uint8_t clip_mode = 0xFF;    /* Mode clip_* was computed for */
+static uint16_t clip_page_y;        /* VRAM line of the active page (SCREEN 5-12) */
+
+/* Bring the clip rectangle and active page up to date; returns the screen mode */
+static uint8_t clip_update(void) {
+    uint8_t mode = sys_read8(SCRMOD);
+    int16_t max_x, max_y;
+
+    clip_page_y = (mode >= 5 && mode <= 12) ? acpage_y(mode) : 0;
+    if (mode == clip_mode) return mode;
+    clip_mode = mode;
+
+    max_x = (mode == 6 || mode == 7) ? 511 : 255;
+    max_y = (mode >= 5 && mode <= 12) ? 211 : 191;
+    clip_x1 = (view_x1 > 0) ? view_x1 : 0;
+    clip_y1 = (view_y1 > 0) ? view_y1 : 0;
+    clip_x2 = (view_x2 < max_x) ? view_x2 : max_x;
+    clip_y2 = (view_y2 < max_y) ? view_y2 : max_y;
+    return mode;
+}
+
+/* Nonzero if the rectangle (x1,y1)-(x2,y2) (x1 <= x2, y1 <= y2) misses the clip rectangle */
+static uint8_t clip_reject(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    return x2 < clip_x1 || x1 > clip_x2 || y2 < clip_y1 || y1 > clip_y2;
+}
+
+/* Visibility of the four mirror images of the offset box
+ * [dx1,dx2] x [dy1,dy2] (0 <= dx1 <= dx2, 0 <= dy1 <= dy2) around (x, y):
+ * bit 0 = (+x,+y), bit 1 = (-x,+y), bit 2 = (+x,-y), bit 3 = (-x,-y) */
+static uint8_t clip_quadrants(int16_t x, int16_t y,
+                              int16_t dx1, int16_t dx2, int16_t dy1, int16_t dy2) {
+    uint8_t vis = 0;
+
+    if (y + dy2 >= clip_y1 && y + dy1 <= clip_y2) {
+        if (x + dx2 >= clip_x1 && x + dx1 <= clip_x2) vis |= 0x01;
+        if (x - dx1 >= clip_x1 && x - dx2 <= clip_x2) vis |= 0x02;
+    }
+    if (y - dy1 >= clip_y1 && y - dy2 <= clip_y2) {
+        if (x + dx2 >= clip_x1 && x + dx1 <= clip_x2) vis |= 0x04;
+        if (x - dx1 >= clip_x1 && x - dx2 <= clip_x2) vis |= 0x08;
+    }
+    return vis;
+}
+
+void basic_view(int16_t x1, int16_t y1, int16_t x2, int16_t y2) {
+    int16_t tmp;
+
+    if (x1 > x2) { tmp = x1; x1 = x2; x2 = tmp; }
+    if (y1 > y2) { tmp = y1; y1 = y2; y2 = tmp; }
+    view_x1 = x1;
+    view_y1 = y1;
+    view_x2 = x2;
+    view_y2 = y2;
+    clip_mode = 0xFF;
+}
+
+void basic_view_reset(void) {
+    basic_view(0, 0, 32767, 32767);
+}
+
+static uint8_t clip_code(int16_t x, int16_t y) {
+    uint8_t code = 0;
+
+    if (x < clip_x1) code |= CLIP_LEFT;
+    else if (x > clip_x2) code |= CLIP_RIGHT;
+    if (y < clip_y1) code |= CLIP_TOP;
+    else if (y > clip_y2) code |= CLIP_BOTTOM;
+    return code;
+}
+
+/* Clip a line in place; returns 0 if nothing is visible */
+static uint8_t clip_line(int16_t* px1, int16_t* py1, int16_t* px2, int16_t* py2) {
+    int16_t x1 = *px1, y1 = *py1, x2 = *px2, y2 = *py2;
+    uint8_t c1 = clip_code(x1, y1);
+    uint8_t c2 = clip_code(x2, y2);
+    uint8_t c;
+    int16_t x, y;
+
+    while (c1 | c2) {
+        /* Both ends on the same outside side: fully invisible */
+        if (c1 & c2) return 0;
+
+        c = c1 ? c1 : c2;
+        if (c & CLIP_TOP) {
+            x = x1 + (int16_t)((int32_t)(x2 - x1) * (clip_y1 - y1) / (y2 - y1));
+            y = clip_y1;
+        } else if (c & CLIP_BOTTOM) {
+            x = x1 + (int16_t)((int32_t)(x2 - x1) * (clip_y2 - y1) / (y2 - y1));
+            y = clip_y2;
+        } else if (c & CLIP_LEFT) {
+            y = y1 + (int16_t)((int32_t)(y2 - y1) * (clip_x1 - x1) / (x2 - x1));
+            x = clip_x1;
+        } else {
+            y = y1 + (int16_t)((int32_t)(y2 - y1) * (clip_x2 - x1) / (x2 - x1));
+            x = clip_x2;
+        }
+
+        if (c == c1) {
+            x1 = x;
+            y1 = y;
+            c1 = clip_code(x1, y1);
+        } else {
+            x2 = x;
+            y2 = y;
+            c2 = clip_code(x2, y2);
+        }
+    }
+
+    *px1 = x1;
+    *py1 = y1;
+    *px2 = x2;
+    *py2 = y2;
+    return 1;
+}
+
 /* Forward declaration for basic_boxfill */
 void basic_boxfill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color);
 
@@ -244,23 +547,15 @@ _pset_wait2:
 extern void basic_pset_msx2(int16_t x, int16_t y, uint8_t color);
 
 void basic_pset(int16_t x, int16_t y, uint8_t color) {
-    uint8_t mode = sys_read8(SCRMOD);
+    uint8_t mode = clip_update();
+
+    /* Clip to the viewport (signed comparison) */
+    if (x < clip_x1 || x > clip_x2 || y < clip_y1 || y > clip_y2) return;
 
     /* MSX2/MSX2+ modes (SCREEN 5-12) use VDP commands */
     if (mode >= 5 && mode <= 12) {
-        int16_t max_x;
         uint8_t packed_color;
 
-        /* Set max_x based on screen mode */
-        if (mode == 6 || mode == 7) {
-            max_x = 511;
-        } else {
-            max_x = 255;
-        }
-
-        /* Bounds check with signed comparison */
-        if (x < 0 || x > max_x || y < 0 || y > 211) return;
-
         /* SCREEN 6: pack color (4 copies of 2-bit color) */
         if (mode == 6) {
             packed_color = pack_color_screen6(color);
@@ -268,8 +563,14 @@ void basic_pset(int16_t x, int16_t y, uint8_t color) {
             packed_color = color;
         }
 
-        /* Call assembly directly with stack parameters */
-        basic_pset_msx2(x, y, packed_color);
+        if (dirty_on) dirty_add(x, y, x, y);
+
+        /* Issue directly when no commands are queued, otherwise queue it */
+        if (vdp_pump() == 0) {
+            basic_pset_msx2(x, y + clip_page_y, packed_color);
+        } else {
+            vdp_pset((uint16_t)x, (uint16_t)y + clip_page_y, packed_color, VDP_LOG_IMP);
+        }
 
         sys_write16(GRPACX, x);
         sys_write16(GRPACY, y);
@@ -292,9 +593,6 @@ void basic_pset(int16_t x, int16_t y, uint8_t color) {
         uint8_t pattern_byte;
         uint8_t color_byte;
 
-        /* Bounds check */
-        if (x < 0 || x > 255 || y < 0 || y > 191) return;
-
         /* Calculate addresses for SCREEN 2
          * Screen is divided into 3 banks (y 0-63, 64-127, 128-191)
          * Each bank has 256 patterns (8 char rows x 32 char cols)
@@ -308,13 +606,13 @@ void basic_pset(int16_t x, int16_t y, uint8_t color) {
         bit_pos = 7 - (x & 7);
 
         /* Read current pattern, set bit */
-        pattern_byte = gfx_rdvrm(pattern_addr);
+        pattern_byte = scr2_peek(pattern_addr);
         pattern_byte |= (1 << bit_pos);
-        gfx_wrtvrm(pattern_addr, pattern_byte);
+        scr2_poke(pattern_addr, pattern_byte);
 
         /* Set color (foreground in high nibble, background in low nibble) */
         color_byte = (color << 4) | (sys_read8(BAKCLR) & 0x0F);
-        gfx_wrtvrm(color_addr, color_byte);
+        scr2_poke(color_addr, color_byte);
     }
 
     /* Update graphic cursor position */
@@ -346,7 +644,8 @@ void basic_init_grp(void) {
 
         /* For SCREEN 8, bg_color is already 0-255 (GRB 332 format)
          * For SCREEN 10-12 (YJK), fill with the specified color value */
-        vdp_fill(0, 0, width, height, packed_color);
+        if (dirty_on) dirty_add(0, 0, width - 1, height - 1);
+        vdp_fill(0, acpage_y(mode), width, height, packed_color);
         return;
     }
 
@@ -357,14 +656,16 @@ void basic_init_grp(void) {
 
     /* MSX1 modes (SCREEN 2-4) - initialize color table */
     {
-        uint16_t addr;
         uint8_t color_byte;
 
         color_byte = (sys_read8(FORCLR) << 4) | (bg_color & 0x0F);
 
-        /* Initialize all 6144 bytes of color table (0x2000-0x37FF) */
-        for (addr = SCR2_COLOR_BASE; addr < SCR2_COLOR_BASE + 0x1800; addr++) {
-            gfx_wrtvrm(addr, color_byte);
+        /* Initialize all 6144 bytes of color table (0x2000-0x37FF) in one stream */
+        vram_filvrm(SCR2_COLOR_BASE, 0x1800, color_byte);
+        if (shadow_buf) {
+            uint16_t i;
+
+            for (i = 0; i < shadow_size; i++) shadow_buf[shadow_size + i] = color_byte;
         }
     }
 }
@@ -379,13 +680,111 @@ void basic_preset(int16_t x, int16_t y) {
     basic_pset(x, y, sys_read8(BAKCLR));
 }
 
-void basic_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
-    uint8_t mode = sys_read8(SCRMOD);
+/* === SCREEN 2/4 line rasterizer ===
+ * The pattern address is linear in the character row:
+ *   addr = ((y >> 3) << 8) + (x & 0xF8) + (y & 7)
+ * so x steps move by 8 bytes at byte boundaries and y steps by 1 (or 249
+ * across a character row). Pixels of an x-major line that share a byte are
+ * merged into one read-modify-write. */
+
+/* Set bits in one pattern byte and its color */
+static void scr2_plot(uint16_t addr, uint8_t bits, uint8_t color_byte) {
+    scr2_poke(SCR2_PATTERN_BASE + addr, scr2_peek(SCR2_PATTERN_BASE + addr) | bits);
+    scr2_poke(SCR2_COLOR_BASE + addr, color_byte);
+}
+
+static void scr2_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    uint16_t addr;
+    uint8_t mask, acc, color_byte, row;
+    int16_t dx, dy, err, n;
+    int8_t sx, sy;
+
+    if (!clip_line(&x1, &y1, &x2, &y2)) return;
+
+    color_byte = (color << 4) | (sys_read8(BAKCLR) & 0x0F);
+
+    dx = x2 - x1;
+    sx = 1;
+    if (dx < 0) { dx = -dx; sx = -1; }
+    dy = y2 - y1;
+    sy = 1;
+    if (dy < 0) { dy = -dy; sy = -1; }
+
+    addr = ((uint16_t)(y1 >> 3) << 8) + (x1 & 0xF8) + (y1 & 7);
+    mask = 0x80 >> (x1 & 7);
+    row = y1 & 7;
+
+/* Move addr/row one pixel row in direction sy */
+#define SCR2_STEP_Y() do { \
+    if (sy > 0) { \
+        if (row == 7) { row = 0; addr += 249; } else { row++; addr++; } \
+    } else { \
+        if (row == 0) { row = 7; addr -= 249; } else { row--; addr--; } \
+    } \
+} while (0)
+
+/* Move mask/addr one pixel in direction sx; flush acc at byte boundaries */
+#define SCR2_STEP_X() do { \
+    if (sx > 0) { \
+        mask >>= 1; \
+        if (!mask) { \
+            if (acc) { scr2_plot(addr, acc, color_byte); acc = 0; } \
+            mask = 0x80; \
+            addr += 8; \
+        } \
+    } else { \
+        mask <<= 1; \
+        if (!mask) { \
+            if (acc) { scr2_plot(addr, acc, color_byte); acc = 0; } \
+            mask = 0x01; \
+            addr -= 8; \
+        } \
+    } \
+} while (0)
+
+    acc = 0;
+    if (dx >= dy) {
+        /* X-major: accumulate the pixels of each byte, write once */
+        err = dx >> 1;
+        for (n = dx; ; n--) {
+            acc |= mask;
+            if (n == 0) break;
+            SCR2_STEP_X();
+            err -= dy;
+            if (err < 0) {
+                err += dx;
+                if (acc) { scr2_plot(addr, acc, color_byte); acc = 0; }
+                SCR2_STEP_Y();
+            }
+        }
+        if (acc) scr2_plot(addr, acc, color_byte);
+    } else {
+        /* Y-major: every pixel is on a new row */
+        err = dy >> 1;
+        for (n = dy; ; n--) {
+            scr2_plot(addr, mask, color_byte);
+            if (n == 0) break;
+            err -= dx;
+            if (err < 0) {
+                err += dy;
+                SCR2_STEP_X();
+            }
+            SCR2_STEP_Y();
+        }
+    }
 
-    /* MSX2+ modes use hardware LINE command */
+#undef SCR2_STEP_X
+#undef SCR2_STEP_Y
+}
+
+/* Draw a clipped line with the engine of mode (from clip_update()) */
+static void line_draw(uint8_t mode, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    /* MSX2+ modes use hardware LINE command on the clipped segment */
     if (mode >= 5 && mode <= 12) {
         uint8_t packed_color;
 
+        if (!clip_line(&x1, &y1, &x2, &y2)) return;
+
         /* SCREEN 6: pack color (4 copies of 2-bit color) */
         if (mode == 6) {
             packed_color = pack_color_screen6(color);
@@ -393,44 +792,24 @@ void basic_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
             packed_color = color;
         }
 
-        vdp_line((uint16_t)x1, (uint16_t)y1, (uint16_t)x2, (uint16_t)y2, packed_color, VDP_LOG_IMP);
-        sys_write16(GRPACX, x2);
-        sys_write16(GRPACY, y2);
+        if (dirty_on) dirty_add(x1, y1, x2, y2);
+        vdp_line((uint16_t)x1, (uint16_t)y1 + clip_page_y, (uint16_t)x2, (uint16_t)y2 + clip_page_y,
+                 packed_color, VDP_LOG_IMP);
         return;
     }
 
-    /* MSX1 modes use software Bresenham */
-    {
-        int16_t dx, dy, sx, sy, err, e2;
-
-        dx = x2 - x1;
-        if (dx < 0) dx = -dx;
-        dy = y2 - y1;
-        if (dy < 0) dy = -dy;
-
-        sx = (x1 < x2) ? 1 : -1;
-        sy = (y1 < y2) ? 1 : -1;
-        err = dx - dy;
-
-        while (1) {
-            basic_pset(x1, y1, color);
-
-            if (x1 == x2 && y1 == y2) break;
+    /* MSX1 modes use the clipped incremental rasterizer */
+    scr2_line(x1, y1, x2, y2, color);
+}
 
-            e2 = err * 2;
-            if (e2 > -dy) {
-                err -= dy;
-                x1 += sx;
-            }
-            if (e2 < dx) {
-                err += dx;
-                y1 += sy;
-            }
-        }
-    }
+void basic_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    uint8_t mode = clip_update();
 
+    /* The graphic cursor moves to the unclipped end point */
     sys_write16(GRPACX, x2);
     sys_write16(GRPACY, y2);
+
+    line_draw(mode, x1, y1, x2, y2, color);
 }
 
 void basic_line_ex(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color, uint8_t style) {
@@ -443,334 +822,1201 @@ void basic_line_ex(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color
     }
 }
 
-void basic_box(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
-    basic_line(x1, y1, x2, y1, color);
-    basic_line(x2, y1, x2, y2, color);
-    basic_line(x2, y2, x1, y2, color);
-    basic_line(x1, y2, x1, y1, color);
-}
+/* === SCREEN 2/4 span-fill engine ===
+ * Pattern and color tables store one byte per 8x1 cell, and the cells of
+ * a pixel row are 8 bytes apart. A rectangle is filled one character-row
+ * band at a time: interior cells get whole pattern bytes, only the two
+ * edge columns are read-modify-written, and each touched cell gets its
+ * color byte written once. */
 
-void basic_boxfill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
-    int16_t tmp;
-    uint8_t mode = sys_read8(SCRMOD);
-    uint8_t packed_color;
+#asm
 
-    if (x1 > x2) { tmp = x1; x1 = x2; x2 = tmp; }
-    if (y1 > y2) { tmp = y1; y1 = y2; y2 = tmp; }
+; void scr2_cells_fill(uint16_t addr, uint8_t cells, uint8_t rows, uint8_t value)
+; Write 'rows' bytes of 'value' into each of 'cells' consecutive 8x8 cells
+; starting at 'addr' (< 0x4000, R#14 already 0). One address setup per cell.
+; Stack: [ret][value][rows][cells][addr]
+PUBLIC _scr2_cells_fill
+_scr2_cells_fill:
+    ld hl, 2
+    add hl, sp
+    ld c, (hl)      ; value
+    inc hl
+    inc hl
+    ld b, (hl)      ; rows
+    inc hl
+    inc hl
+    ld a, (hl)      ; cells
+    inc hl
+    inc hl
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = addr
+    ld h, a         ; H = cells
+    ld l, b         ; L = rows
+    or a
+    ret z
+    ld a, l
+    or a
+    ret z
+    di
+_scr2_cf_cell:
+    ld a, e
+    out (0x99), a
+    ld a, d
+    and 0x3F
+    or 0x40         ; write mode
+    out (0x99), a
+    ld b, l
+    ld a, c
+_scr2_cf_row:
+    out (0x98), a
+    nop             ; keep 29 T-states between writes (TMS9918)
+    djnz _scr2_cf_row
+    ld a, e         ; next cell: addr += 8
+    add a, 8
+    ld e, a
+    jr nc, _scr2_cf_next
+    inc d
+_scr2_cf_next:
+    dec h
+    jr nz, _scr2_cf_cell
+    ei
+    ret
 
-    /* MSX2/MSX2+ modes (SCREEN 5-12) use hardware fill */
-    if (mode >= 5 && mode <= 12) {
-        /* SCREEN 6: 4 colors, need to pack color byte */
-        if (mode == 6) {
-            packed_color = pack_color_screen6(color);
-        } else {
-            packed_color = color;
+#endasm
+
+extern void scr2_cells_fill(uint16_t addr, uint8_t cells, uint8_t rows, uint8_t value);
+
+/* Write 'value' to 'rows' bytes of 'cells' adjacent cells in one band */
+static void scr2_run(uint16_t addr, uint8_t cells, uint8_t rows, uint8_t value) {
+    uint8_t* p = shadow_ptr(addr);
+    uint8_t i;
+
+    if (p) {
+        /* The band is in RAM */
+        for (; cells; cells--, addr += 8, p += 8) {
+            for (i = 0; i < rows; i++) p[i] = value;
+            shadow_mark(addr);
         }
-        vdp_fill((uint16_t)x1, (uint16_t)y1,
-                 (uint16_t)(x2 - x1 + 1), (uint16_t)(y2 - y1 + 1), packed_color);
         return;
     }
-
-    /* MSX1 modes use software fill */
-    {
-        int16_t y;
-        for (y = y1; y <= y2; y++) {
-            basic_line(x1, y, x2, y, color);
-        }
+    if (rows == 8) {
+        /* Whole band rows: the cells are contiguous in VRAM */
+        vram_filvrm(addr, (uint16_t)cells << 3, value);
+    } else {
+        scr2_cells_fill(addr, cells, rows, value);
     }
 }
 
-void basic_circle(int16_t x, int16_t y, int16_t radius, uint8_t color) {
-    /* Bresenham circle algorithm - accurate circle for all modes */
-    int16_t cx = 0;
-    int16_t cy = radius;
-    int16_t d = 1 - radius;
-
-    while (cx <= cy) {
-        basic_pset(x + cx, y + cy, color);
-        basic_pset(x - cx, y + cy, color);
-        basic_pset(x + cx, y - cy, color);
-        basic_pset(x - cx, y - cy, color);
-        basic_pset(x + cy, y + cx, color);
-        basic_pset(x - cy, y + cx, color);
-        basic_pset(x + cy, y - cx, color);
-        basic_pset(x - cy, y - cx, color);
+/* OR 'mask' into 'rows' pattern bytes of one edge cell */
+static void scr2_merge(uint16_t addr, uint8_t rows, uint8_t mask) {
+    uint8_t buf[8];
+    uint8_t i;
+    uint8_t* p = shadow_ptr(addr);
 
-        if (d < 0) {
-            d += 2 * cx + 3;
-        } else {
-            d += 2 * (cx - cy) + 5;
-            cy--;
-        }
-        cx++;
+    if (p) {
+        for (i = 0; i < rows; i++) p[i] |= mask;
+        shadow_mark(addr);
+        return;
     }
 
-    sys_write16(GRPACX, x);
-    sys_write16(GRPACY, y);
+    vram_ldirmv(buf, addr, rows);
+    for (i = 0; i < rows; i++) {
+        buf[i] |= mask;
+    }
+    vram_ldirvm(addr, buf, rows);
 }
 
-/* Sine table for 0-90 degrees, scaled by 256 (sin * 256) */
-static const uint8_t sin_table[91] = {
-    0, 4, 9, 13, 18, 22, 27, 31, 36, 40, 44, 49, 53, 58, 62, 66,
-    71, 75, 79, 83, 88, 92, 96, 100, 104, 108, 112, 116, 120, 124, 128, 131,
-    135, 139, 142, 146, 149, 152, 156, 159, 162, 165, 168, 171, 174, 177, 180, 183,
-    185, 188, 190, 193, 195, 198, 200, 202, 204, 206, 208, 210, 212, 214, 215, 217,
-    219, 220, 222, 223, 224, 226, 227, 228, 229, 230, 231, 232, 233, 234, 234, 235,
-    236, 236, 237, 237, 238, 238, 239, 239, 239, 240, 240
-};
-
-/* Get sin value * 256 for angle in degrees */
-static int16_t get_sin256(int16_t deg) {
-    int8_t neg = 0;
-
-    /* Normalize to 0-359 */
-    while (deg < 0) deg += 360;
-    while (deg >= 360) deg -= 360;
+/* Fill rectangle (x1,y1)-(x2,y2) on SCREEN 2/4 (x1 <= x2, y1 <= y2);
+ * clip_update() must have been called */
+static void scr2_fill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    uint8_t color_byte;
+    uint8_t lmask, rmask;
+    uint8_t cx1, cx2, first, last;
+    uint8_t ya, yb, rows;
+    uint16_t addr;
 
-    /* Handle quadrants */
-    if (deg > 270) {
-        deg = 360 - deg;
-        neg = 1;
-    } else if (deg > 180) {
-        deg = deg - 180;
-        neg = 1;
-    } else if (deg > 90) {
-        deg = 180 - deg;
+    /* Clip to the viewport */
+    if (x1 < clip_x1) x1 = clip_x1;
+    if (y1 < clip_y1) y1 = clip_y1;
+    if (x2 > clip_x2) x2 = clip_x2;
+    if (y2 > clip_y2) y2 = clip_y2;
+    if (x1 > x2 || y1 > y2) return;
+
+    color_byte = (color << 4) | (sys_read8(BAKCLR) & 0x0F);
+
+    cx1 = (uint8_t)(x1 >> 3);
+    cx2 = (uint8_t)(x2 >> 3);
+    lmask = 0xFF >> (x1 & 7);
+    rmask = 0xFF << (7 - (x2 & 7));
+    if (cx1 == cx2) {
+        lmask &= rmask;
+        rmask = 0xFF;
     }
 
-    return neg ? -(int16_t)sin_table[deg] : (int16_t)sin_table[deg];
-}
+    /* Cells written with whole pattern bytes */
+    first = (lmask == 0xFF) ? cx1 : cx1 + 1;
+    last = (rmask == 0xFF) ? cx2 : cx2 - 1;
 
-/* Get cos value * 256 for angle in degrees */
-static int16_t get_cos256(int16_t deg) {
-    return get_sin256(deg + 90);
-}
+    /* Select VRAM bank 0 (R#14) for the raw address setups below */
+    vram_set_write(SCR2_PATTERN_BASE);
 
-void basic_circle_ex(int16_t x, int16_t y, int16_t radius, uint8_t color,
-                     int16_t start_deg, int16_t end_deg, int16_t aspect_100) {
-    int16_t deg;
-    int16_t rx, ry;
-    int16_t px, py;
+    ya = (uint8_t)y1;
+    while (1) {
+        yb = ya | 7;
+        if (yb > (uint8_t)y2) yb = (uint8_t)y2;
+        rows = yb - ya + 1;
+        addr = ((uint16_t)(ya >> 6) << 11) + ((uint16_t)((ya >> 3) & 7) << 8) + (ya & 7);
 
-    /* Default aspect ratio is 100 (1:1) */
-    if (aspect_100 <= 0) aspect_100 = 100;
+        /* Pattern: masked read-modify-write on the edge cells only */
+        if (lmask != 0xFF) scr2_merge(SCR2_PATTERN_BASE + addr + ((uint16_t)cx1 << 3), rows, lmask);
+        if (rmask != 0xFF) scr2_merge(SCR2_PATTERN_BASE + addr + ((uint16_t)cx2 << 3), rows, rmask);
 
-    /* Normalize angles */
-    while (start_deg < 0) start_deg += 360;
-    while (end_deg < 0) end_deg += 360;
-    while (start_deg >= 360) start_deg -= 360;
-    while (end_deg >= 360) end_deg -= 360;
+        /* Pattern: whole bytes for the interior */
+        if (last >= first) {
+            scr2_run(SCR2_PATTERN_BASE + addr + ((uint16_t)first << 3), last - first + 1, rows, 0xFF);
+        }
 
-    /* Calculate radii based on aspect ratio */
-    if (aspect_100 >= 100) {
-        rx = radius;
-        ry = (int16_t)((int32_t)radius * 100 / aspect_100);
-    } else {
-        rx = (int16_t)((int32_t)radius * aspect_100 / 100);
-        ry = radius;
+        /* Color: once per 8x1 cell */
+        scr2_run(SCR2_COLOR_BASE + addr + ((uint16_t)cx1 << 3), cx2 - cx1 + 1, rows, color_byte);
+
+        if (yb == (uint8_t)y2) break;
+        ya = yb + 1;
     }
+    vram_close();
+}
 
-    /* Draw arc by stepping through angles */
-    for (deg = start_deg; ; deg++) {
-        if (deg >= 360) deg -= 360;
+/* Fill rectangle (x1,y1)-(x2,y2) (x1 <= x2, y1 <= y2) clipped to the
+ * viewport with the engine of the current mode; clip_update() must have
+ * been called */
+static void fill_rect(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    uint8_t mode = clip_mode;
 
-        /* Calculate point on ellipse */
-        px = x + (int16_t)((int32_t)rx * get_cos256(deg) / 256);
-        py = y - (int16_t)((int32_t)ry * get_sin256(deg) / 256);
+    if (mode >= 5 && mode <= 12) {
+        if (x1 < clip_x1) x1 = clip_x1;
+        if (y1 < clip_y1) y1 = clip_y1;
+        if (x2 > clip_x2) x2 = clip_x2;
+        if (y2 > clip_y2) y2 = clip_y2;
+        if (x1 > x2 || y1 > y2) return;
+        if (dirty_on) dirty_add(x1, y1, x2, y2);
+
+        /* SCREEN 6: 4 colors, need to pack color byte */
+        vdp_fill((uint16_t)x1, (uint16_t)y1 + clip_page_y, (uint16_t)(x2 - x1 + 1), (uint16_t)(y2 - y1 + 1),
+                 (mode == 6) ? pack_color_screen6(color) : color);
+    } else {
+        /* scr2_fill clips itself */
+        scr2_fill(x1, y1, x2, y2, color);
+    }
+}
 
-        basic_pset(px, py, color);
+/* Outline (x1,y1)-(x2,y2) with the engine of the mode; clip_update()
+ * must have been called */
+static void box_draw(uint8_t mode, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    int16_t lx, rx, ty, by;
 
-        if (deg == end_deg) break;
+    if (mode >= 5 && mode <= 12) {
+        line_draw(mode, x1, y1, x2, y1, color);
+        line_draw(mode, x2, y1, x2, y2, color);
+        line_draw(mode, x2, y2, x1, y2, color);
+        line_draw(mode, x1, y2, x1, y1, color);
+        return;
     }
 
-    sys_write16(GRPACX, x);
-    sys_write16(GRPACY, y);
+    /* MSX1 modes: each edge is a one-pixel-thick span fill (clipped) */
+    lx = (x1 < x2) ? x1 : x2;
+    rx = (x1 < x2) ? x2 : x1;
+    ty = (y1 < y2) ? y1 : y2;
+    by = (y1 < y2) ? y2 : y1;
+
+    scr2_fill(lx, ty, rx, ty, color);
+    scr2_fill(lx, by, rx, by, color);
+    scr2_fill(lx, ty, lx, by, color);
+    scr2_fill(rx, ty, rx, by, color);
 }
 
-void basic_ellipse(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color) {
-    int32_t rx2 = (int32_t)rx * rx;
-    int32_t ry2 = (int32_t)ry * ry;
+void basic_box(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    box_draw(clip_update(), x1, y1, x2, y2, color);
+
+    /* The graphic cursor ends at the start corner */
+    sys_write16(GRPACX, x1);
+    sys_write16(GRPACY, y1);
+}
+
+void basic_boxfill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    int16_t tmp;
+    uint8_t mode = clip_update();
+
+    if (x1 > x2) { tmp = x1; x1 = x2; x2 = tmp; }
+    if (y1 > y2) { tmp = y1; y1 = y2; y2 = tmp; }
+
+    /* Hardware fill on MSX2 modes (SCREEN 5-12), span-fill engine on MSX1 */
+    fill_rect(x1, y1, x2, y2, color);
+
+    if (mode < 5 || mode > 12) {
+        sys_write16(GRPACX, x2);
+        sys_write16(GRPACY, y2);
+    }
+}
+
+void basic_circle(int16_t x, int16_t y, int16_t radius, uint8_t color) {
+    /* Bresenham circle algorithm - accurate circle for all modes */
     int16_t cx = 0;
-    int16_t cy = ry;
-    int32_t px = 0;
-    int32_t py = 2 * rx2 * cy;
-    int32_t p;
-
-    p = ry2 - rx2 * ry + rx2 / 4;
-    while (px < py) {
-        basic_pset(x + cx, y + cy, color);
-        basic_pset(x - cx, y + cy, color);
-        basic_pset(x + cx, y - cy, color);
-        basic_pset(x - cx, y - cy, color);
+    int16_t cy = radius;
+    int16_t d = 1 - radius;
+    int16_t h = (int16_t)(((int32_t)radius * 181) >> 8);  /* ~radius / sqrt(2) */
+    uint8_t vis = 0;
+
+    /* Octant rejection: cx stays in [0, h+2] and cy in [h-1, radius] */
+    clip_update();
+    if (radius >= 0) {
+        vis = clip_quadrants(x, y, 0, h + 2, h - 1, radius) |
+              (clip_quadrants(x, y, h - 1, radius, 0, h + 2) << 4);
+    }
 
-        cx++;
-        px += 2 * ry2;
-        if (p < 0) {
-            p += ry2 + px;
+    while (vis && cx <= cy) {
+        if (vis & 0x01) basic_pset(x + cx, y + cy, color);
+        if (vis & 0x02) basic_pset(x - cx, y + cy, color);
+        if (vis & 0x04) basic_pset(x + cx, y - cy, color);
+        if (vis & 0x08) basic_pset(x - cx, y - cy, color);
+        if (vis & 0x10) basic_pset(x + cy, y + cx, color);
+        if (vis & 0x20) basic_pset(x - cy, y + cx, color);
+        if (vis & 0x40) basic_pset(x + cy, y - cx, color);
+        if (vis & 0x80) basic_pset(x - cy, y - cx, color);
+
+        if (d < 0) {
+            d += 2 * cx + 3;
         } else {
+            d += 2 * (cx - cy) + 5;
             cy--;
-            py -= 2 * rx2;
-            p += ry2 + px - py;
         }
+        cx++;
+    }
+
+    sys_write16(GRPACX, x);
+    sys_write16(GRPACY, y);
+}
+
+/* Sine table for 0-90 degrees, scaled by 256 (sin * 256) */
+static const uint16_t sin_table[91] = {
+    0, 4, 9, 13, 18, 22, 27, 31, 36, 40, 44, 49, 53, 58, 62, 66,
+    71, 75, 79, 83, 88, 92, 96, 100, 104, 108, 112, 116, 120, 124, 128, 132,
+    136, 139, 143, 147, 150, 154, 158, 161, 165, 168, 171, 175, 178, 181, 184, 187,
+    190, 193, 196, 199, 202, 204, 207, 210, 212, 215, 217, 219, 222, 224, 226, 228,
+    230, 232, 234, 236, 237, 239, 241, 242, 243, 245, 246, 247, 248, 249, 250, 251,
+    252, 253, 254, 254, 255, 255, 255, 256, 256, 256, 256
+};
+
+/* === Conic row walker ===
+ * Ellipses are rasterized by rows. With ax = rx^2, ay = ry^2 and k = |dy|,
+ * the half-width w of row k is tracked through the slack
+ *   d = ax * ay - ay * w^2 - ax * k^2
+ * using additions only, so the loops contain no multiplication. A pixel is
+ * inside while d + max(ax*k, ay*w) > 0. This is the midpoint outline's
+ * decision, so a circle gets exactly the basic_circle() shape. Output is
+ * collected into runs: equal spans on adjacent rows are merged into one
+ * rectangle (one LMMV or one span-fill).
+ * For a circle (ax = ay = r^2) every term has the factor r^2; the walker
+ * then tracks e = d / r^2 = r^2 - w^2 - k^2, which stays within a few
+ * times r of zero, in 16-bit arithmetic. */
+
+/* Largest radius for the incremental walk (keeps d within int32_t) */
+#define CONIC_MAX_R 511
+
+/* Largest circle radius for the 16-bit walker */
+#define CONIC_MAX_R16 255
+
+/* Walker state */
+static int32_t cw_ax, cw_ay, cw_d, cw_sx, cw_axk, cw_ayw;
+static int16_t cw_w;
+static uint8_t cw_c16;              /* 1: circle, 16-bit state below */
+static int16_t cw_e, cw_k;
+
+/* Start at the top row k = ry with w = 0 (0 < ry, rx <= CONIC_MAX_R) */
+static void conic_start(int16_t rx, int16_t ry) {
+    cw_w = 0;
+    cw_c16 = (rx == ry && rx <= CONIC_MAX_R16);
+    if (cw_c16) {
+        cw_e = 0;
+        cw_k = ry;
+        return;
     }
+    cw_ax = (int32_t)rx * rx;
+    cw_ay = (int32_t)ry * ry;
+    cw_d = 0;
+    cw_sx = cw_ay;                  /* ay * (2w + 1): cost of w -> w + 1 */
+    cw_ayw = 0;                     /* ay * w */
+    cw_axk = cw_ax * ry;            /* ax * k */
+}
+
+/* Widen w to the half-width of the current row */
+static int16_t conic_widen(void) {
+    int32_t b;
+    int16_t m;
+
+    if (cw_c16) {
+        while (1) {
+            m = (cw_k > cw_w + 1) ? cw_k : cw_w + 1;
+            if (cw_e - (2 * cw_w + 1) + m <= 0) break;
+            cw_e -= 2 * cw_w + 1;
+            cw_w++;
+        }
+        return cw_w;
+    }
+
+    while (1) {
+        b = (cw_axk > cw_ayw + cw_ay) ? cw_axk : cw_ayw + cw_ay;
+        if (cw_d - cw_sx + b <= 0) break;
+        cw_d -= cw_sx;
+        cw_sx += 2 * cw_ay;
+        cw_ayw += cw_ay;
+        cw_w++;
+    }
+    return cw_w;
+}
+
+/* Move one row toward the center (k -> k - 1); call conic_widen() next */
+static void conic_up(void) {
+    if (cw_c16) {
+        cw_e += 2 * cw_k - 1;
+        cw_k--;
+        return;
+    }
+    cw_d += 2 * cw_axk - cw_ax;
+    cw_axk -= cw_ax;
+}
+
+/* Move one row away from the center (k -> k + 1) and narrow w to fit */
+static int16_t conic_down(void) {
+    int32_t b;
+
+    if (cw_c16) {
+        cw_e -= 2 * cw_k + 1;
+        cw_k++;
+        while (cw_w > 0) {
+            if (cw_e + ((cw_k > cw_w) ? cw_k : cw_w) > 0) break;
+            cw_w--;
+            cw_e += 2 * cw_w + 1;
+        }
+        return cw_w;
+    }
+
+    cw_d -= 2 * cw_axk + cw_ax;
+    cw_axk += cw_ax;
+    while (cw_w > 0) {
+        b = (cw_axk > cw_ayw) ? cw_axk : cw_ayw;
+        if (cw_d + b > 0) break;
+        cw_w--;
+        cw_sx -= 2 * cw_ay;
+        cw_d += cw_sx;
+        cw_ayw -= cw_ay;
+    }
+    return cw_w;
+}
 
-    p = ry2 * (cx + 1) * (cx + 1) / 4 + rx2 * (cy - 1) * (cy - 1) - rx2 * ry2;
-    while (cy >= 0) {
-        basic_pset(x + cx, y + cy, color);
-        basic_pset(x - cx, y + cy, color);
-        basic_pset(x + cx, y - cy, color);
-        basic_pset(x - cx, y - cy, color);
+static uint16_t isqrt32(uint32_t v) {
+    uint32_t bit = 0x40000000UL;
+    uint32_t r = 0;
 
-        cy--;
-        py -= 2 * rx2;
-        if (p > 0) {
-            p += rx2 - py;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= r + bit) {
+            v -= r + bit;
+            r = (r >> 1) + bit;
         } else {
-            cx++;
-            px += 2 * ry2;
-            p += rx2 - py + px;
+            r >>= 1;
         }
+        bit >>= 2;
     }
+    return (uint16_t)r;
 }
 
-/* Stack for scanline flood fill - limited size for MSX memory constraints */
-#define PAINT_STACK_SIZE 128
+/* Half-width of row k for radii above CONIC_MAX_R (ry > 0): one square root */
+static int16_t conic_width_big(int16_t rx, int16_t ry, int16_t k) {
+    return (int16_t)((int32_t)rx * isqrt32((uint32_t)(ry - k) * (ry + k) + ry) / ry);
+}
 
+/* Run of equal spans on adjacent rows */
 typedef struct {
-    int16_t x1, x2, y, dy;
-} PaintSpan;
+    int16_t x1, x2;     /* Extent, already clipped */
+    int16_t y, rows;    /* First row and row count (0 = empty) */
+} SpanRun;
 
-static PaintSpan paint_stack[PAINT_STACK_SIZE];
-static int16_t paint_sp;
+static SpanRun span_run[4];
+static uint8_t run_color;
 
-static void paint_push(int16_t x1, int16_t x2, int16_t y, int16_t dy) {
-    if (paint_sp < PAINT_STACK_SIZE) {
-        paint_stack[paint_sp].x1 = x1;
-        paint_stack[paint_sp].x2 = x2;
-        paint_stack[paint_sp].y = y;
-        paint_stack[paint_sp].dy = dy;
-        paint_sp++;
+static void run_flush(SpanRun* r) {
+    if (r->rows) {
+        fill_rect(r->x1, r->y, r->x2, r->y + r->rows - 1, run_color);
+        r->rows = 0;
     }
 }
 
-static int paint_pop(int16_t *x1, int16_t *x2, int16_t *y, int16_t *dy) {
-    if (paint_sp > 0) {
-        paint_sp--;
-        *x1 = paint_stack[paint_sp].x1;
-        *x2 = paint_stack[paint_sp].x2;
-        *y = paint_stack[paint_sp].y;
-        *dy = paint_stack[paint_sp].dy;
-        return 1;
+/* Add span x1..x2 on row y, extending the run if it is directly above or below */
+static void run_add(SpanRun* r, int16_t x1, int16_t x2, int16_t y) {
+    if (y < clip_y1 || y > clip_y2) return;
+    if (x1 < clip_x1) x1 = clip_x1;
+    if (x2 > clip_x2) x2 = clip_x2;
+    if (x1 > x2) return;
+    if (r->rows && x1 == r->x1 && x2 == r->x2) {
+        if (y == r->y + r->rows) {
+            r->rows++;
+            return;
+        }
+        if (y == r->y - 1) {
+            r->y--;
+            r->rows++;
+            return;
+        }
     }
-    return 0;
+    run_flush(r);
+    r->x1 = x1;
+    r->x2 = x2;
+    r->y = y;
+    r->rows = 1;
 }
 
-void basic_paint(int16_t x, int16_t y, uint8_t color, uint8_t border) {
-    uint8_t mode = sys_read8(SCRMOD);
-    int16_t max_x, max_y;
-    int16_t x1, x2, ny, dy;
-    int16_t lx, rx;
-    uint8_t target_color;
+/* Nonzero if row y - k or y + k is inside the clip rectangle */
+static uint8_t conic_row_visible(int16_t y, int16_t k) {
+    return (y - k >= clip_y1 && y - k <= clip_y2) || (y + k >= clip_y1 && y + k <= clip_y2);
+}
 
-    /* Get screen dimensions */
-    if (mode == 6 || mode == 7) {
-        max_x = 511;
+/* === Ellipse outline ===
+ * The outline of row k runs from just past the half-width of the outer row
+ * (k + 1) to the half-width of row k, at least one pixel. It is mirrored
+ * into the quadrants enabled in ell_vis (bit 0 = (+x,+y), bit 1 = (-x,+y),
+ * bit 2 = (+x,-y), bit 3 = (-x,-y) in screen coordinates). Each quadrant
+ * collects its spans in its own run, so a flat part becomes one horizontal
+ * span and a steep part one vertical run. Quadrants in ell_part are only
+ * partly covered by an arc and clip their spans to its angle ranges. */
+
+/* Part of a quadrant between two angles. An angle is reduced to one
+ * coordinate threshold: X where the outline is flat (the walk steps in x)
+ * or Y where it is steep, so clipping a span costs two 16-bit compares. */
+typedef struct {
+    int16_t lo_v, hi_v;     /* Thresholds of the start and end angles */
+    uint8_t lo_y, hi_y;     /* 1 if the threshold is on Y */
+} ArcRange;
+
+static int16_t ell_x, ell_y;
+static uint8_t ell_vis;
+static uint8_t ell_part;
+static ArcRange arc_rng[4][2];
+static uint8_t arc_cnt[4];
+
+/* Emit quadrant-local span lo..hi on row k into the run of quadrant q */
+static void ell_emit(uint8_t q, int16_t lo, int16_t hi, int16_t k) {
+    int16_t y = (q & 2) ? ell_y - k : ell_y + k;
+
+    if (q & 1) {
+        run_add(&span_run[q], ell_x - hi, ell_x - lo, y);
     } else {
-        max_x = 255;
+        run_add(&span_run[q], ell_x + lo, ell_x + hi, y);
     }
-    max_y = (mode >= 5 && mode <= 12) ? 211 : 191;
+}
 
-    /* Bounds check */
-    if (x < 0 || x > max_x || y < 0 || y > max_y) return;
+/* Clip span lo..hi on row k of quadrant q to its arc ranges and emit it */
+static void ell_span(uint8_t q, int16_t lo, int16_t hi, int16_t k) {
+    ArcRange* r;
+    int16_t a, b;
+    uint8_t n;
 
-    /* Get the color at starting point */
-    target_color = basic_point(x, y);
+    if (!(ell_part & (1 << q))) {
+        ell_emit(q, lo, hi, k);
+        return;
+    }
+    for (r = arc_rng[q], n = arc_cnt[q]; n; n--, r++) {
+        a = lo;
+        b = hi;
+        if (r->lo_y) {
+            if (k < r->lo_v) continue;
+        } else if (b > r->lo_v) {
+            b = r->lo_v;
+        }
+        if (r->hi_y) {
+            if (k > r->hi_v) continue;
+        } else if (a < r->hi_v) {
+            a = r->hi_v;
+        }
+        if (a <= b) ell_emit(q, a, b, k);
+    }
+}
 
-    /* Don't fill if starting point is already the fill color or border */
-    if (target_color == color || target_color == border) return;
+/* Outline of row k: outer row half-width prev (-1 above the top), this row w */
+static void ell_row(int16_t k, int16_t prev, int16_t w) {
+    uint8_t full = ell_vis & ~ell_part;
+    int16_t lo = (prev < w) ? prev + 1 : w;
+    uint8_t q;
+
+    for (q = 0; q < 4; q++) {
+        if (!(ell_vis & (1 << q))) continue;
+        /* Pixels on an axis are drawn once when the mirror quadrant draws them */
+        if ((q & 2) && k == 0 && (full & (1 << (q - 2)))) continue;
+        if ((q & 1) && lo == 0 && (full & (1 << (q - 1)))) {
+            if (w > 0) ell_span(q, 1, w, k);
+            continue;
+        }
+        ell_span(q, lo, w, k);
+    }
+}
 
-    /* Initialize stack */
-    paint_sp = 0;
+/* Draw the outline quadrants selected by ell_vis/ell_part; clip_update()
+ * must have been called */
+static void ellipse_draw(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color) {
+    int16_t k, w, prev;
+    uint8_t q;
+
+    ell_x = x;
+    ell_y = y;
+    run_color = color;
+    for (q = 0; q < 4; q++) span_run[q].rows = 0;
+
+    if (ry == 0) {
+        ell_row(0, -1, rx);
+    } else if (rx > CONIC_MAX_R || ry > CONIC_MAX_R) {
+        /* Huge radii: one square root per row that can be visible */
+        prev = -1;
+        for (k = ry; k >= 0; k--) {
+            if (!conic_row_visible(y, k)) {
+                prev = -2;
+                continue;
+            }
+            if (prev == -2) prev = conic_width_big(rx, ry, k + 1);
+            w = conic_width_big(rx, ry, k);
+            ell_row(k, prev, w);
+            prev = w;
+        }
+    } else {
+        conic_start(rx, ry);
+        prev = -1;
+        for (k = ry; ; k--) {
+            w = conic_widen();
+            if (conic_row_visible(y, k)) ell_row(k, prev, w);
+            if (k == 0) break;
+            prev = w;
+            conic_up();
+        }
+    }
 
-    /* Push initial span */
-    paint_push(x, x, y, 1);
-    paint_push(x, x, y - 1, -1);
+    for (q = 0; q < 4; q++) run_flush(&span_run[q]);
+}
 
-    while (paint_pop(&x1, &x2, &y, &dy)) {
-        ny = y + dy;
+/* Threshold of quadrant-local angle deg (0-90) on the (rx, ry) ellipse */
+static void arc_bound(int16_t deg, int16_t rx, int16_t ry, int16_t* v, uint8_t* use_y) {
+    int16_t bx = (int16_t)(((int32_t)rx * sin_table[90 - deg] + 128) >> 8);
+    int16_t by = (int16_t)(((int32_t)ry * sin_table[deg] + 128) >> 8);
 
-        /* Bounds check for new y */
-        if (ny < 0 || ny > max_y) continue;
+    /* The walk steps in x while ry^2 * x < rx^2 * y (region 1) */
+    if ((int32_t)ry * ry * bx < (int32_t)rx * rx * by) {
+        *v = bx;
+        *use_y = 0;
+    } else {
+        *v = by;
+        *use_y = 1;
+    }
+}
 
-        /* Scan left from x1 */
-        lx = x1;
-        while (lx > 0) {
-            uint8_t c = basic_point(lx - 1, ny);
-            if (c == border || c == color) break;
-            lx--;
+/* Add the arc a..b (0 <= a < b <= 360, counterclockwise) to the quadrants */
+static void arc_add(int16_t a, int16_t b, int16_t rx, int16_t ry) {
+    /* Quadrant bit of each 90-degree sector, counterclockwise from +x */
+    static const uint8_t sector_q[4] = { 2, 3, 1, 0 };
+    int16_t lo, hi, base, plo, phi;
+    uint8_t s, q;
+    ArcRange* r;
+
+    for (s = 0; s < 4; s++) {
+        base = (int16_t)s * 90;
+        lo = (a > base) ? a : base;
+        hi = (b < base + 90) ? b : base + 90;
+        if (lo >= hi) continue;
+
+        /* Quadrant-local angle runs from the x axis toward the y axis */
+        if (s & 1) {
+            plo = base + 90 - hi;
+            phi = base + 90 - lo;
+        } else {
+            plo = lo - base;
+            phi = hi - base;
         }
 
-        /* Scan right from x2 */
-        rx = x2;
-        while (rx < max_x) {
-            uint8_t c = basic_point(rx + 1, ny);
-            if (c == border || c == color) break;
-            rx++;
-        }
+        q = sector_q[s];
+        r = &arc_rng[q][arc_cnt[q]++];
+        arc_bound(plo, rx, ry, &r->lo_v, &r->lo_y);
+        arc_bound(phi, rx, ry, &r->hi_v, &r->hi_y);
+        if (plo != 0 || phi != 90) ell_part |= 1 << q;
+    }
+}
 
-        /* Check if current point is valid */
-        {
-            uint8_t c = basic_point(x1, ny);
-            if (c == border || c == color) {
-                /* Find next valid segment */
-                int16_t sx = x1;
-                while (sx <= rx) {
-                    c = basic_point(sx, ny);
-                    if (c != border && c != color) break;
-                    sx++;
-                }
-                if (sx > rx) continue;
-                lx = sx;
-                while (lx > 0) {
-                    c = basic_point(lx - 1, ny);
-                    if (c == border || c == color) break;
-                    lx--;
-                }
+void basic_circle_ex(int16_t x, int16_t y, int16_t radius, uint8_t color,
+                     int16_t start_deg, int16_t end_deg, int16_t aspect_100) {
+    int16_t rx, ry, len;
+    uint8_t q;
+
+    /* Default aspect ratio is 100 (1:1) */
+    if (aspect_100 <= 0) aspect_100 = 100;
+
+    /* Arc length; equal angles (mod 360) draw the whole ellipse */
+    start_deg %= 360;
+    if (start_deg < 0) start_deg += 360;
+    end_deg %= 360;
+    if (end_deg < 0) end_deg += 360;
+    len = end_deg - start_deg;
+    if (len <= 0) len += 360;
+
+    /* Calculate radii based on aspect ratio */
+    if (aspect_100 >= 100) {
+        rx = radius;
+        ry = (int16_t)((int32_t)radius * 100 / aspect_100);
+    } else {
+        rx = (int16_t)((int32_t)radius * aspect_100 / 100);
+        ry = radius;
+    }
+
+    sys_write16(GRPACX, x);
+    sys_write16(GRPACY, y);
+
+    /* Quadrant rejection against the viewport, then against the arc */
+    clip_update();
+    if (rx < 0 || ry < 0) return;
+    ell_vis = clip_quadrants(x, y, 0, rx, 0, ry);
+    if (!ell_vis) return;
+
+    ell_part = 0;
+    for (q = 0; q < 4; q++) arc_cnt[q] = 0;
+    if (start_deg + len <= 360) {
+        arc_add(start_deg, start_deg + len, rx, ry);
+    } else {
+        arc_add(start_deg, 360, rx, ry);
+        arc_add(0, start_deg + len - 360, rx, ry);
+    }
+    for (q = 0; q < 4; q++) {
+        if (!arc_cnt[q]) ell_vis &= ~(1 << q);
+    }
+    if (!ell_vis) return;
+
+    ellipse_draw(x, y, rx, ry, color);
+}
+
+void basic_ellipse(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color) {
+    /* Quadrant rejection against the viewport */
+    clip_update();
+    if (rx < 0 || ry < 0) return;
+    ell_vis = clip_quadrants(x, y, 0, rx, 0, ry);
+    if (!ell_vis) return;
+
+    ell_part = 0;
+    ellipse_draw(x, y, rx, ry, color);
+}
+
+/* === Scanline flood fill ===
+ * Spans are found per scanline and every filled span is written in one
+ * operation (LMMV on MSX2, span-fill engine on MSX1).
+ * SCREEN 5-8: span ends are found by the VDP SRCH command; the CPU queues
+ *   spans while the VDP searches and fills, and waits for a fill only
+ *   when it reads a pixel of that fill.
+ * Other modes: each scanline is read into a RAM cache with one bulk VRAM
+ *   read and span boundaries are found in RAM.
+ * The span stack lives in a caller-supplied arena (after the scanline
+ * cache when one is needed). The fill is bounded by the viewport. */
+
+typedef struct {
+    int16_t x1, x2;     /* Span of the parent line that was filled */
+    uint8_t y;          /* Line to explore */
+    int8_t dy;          /* Direction from the parent line */
+} PaintSpan;
+
+/* Default arena for basic_paint: a scanline cache of up to 256 bytes
+ * and 128 spans, or 170 spans in SCREEN 5-8 where SRCH needs no cache */
+static uint8_t paint_arena[1024];
+
+static PaintSpan* paint_stack;
+static uint16_t paint_cap;
+static uint16_t paint_sp;
+static uint8_t paint_overflow;
+static uint8_t paint_mode;
+static uint8_t paint_color;
+static uint8_t paint_border;
+static uint8_t paint_fill_color;    /* paint_color packed for the VDP */
+static uint16_t paint_page_y;
+static int16_t paint_min_x;         /* Fill bounds: the clip rectangle */
+static int16_t paint_min_y;
+static int16_t paint_max_x;
+static int16_t paint_max_y;
+
+/* SCREEN 5-8: last queued fill. Every SRCH result drains the queue, so it
+ * is the only fill that may still be running. */
+static int16_t paint_fill_y = -1;
+static int16_t paint_fill_x1;
+static int16_t paint_fill_x2;
+static uint16_t paint_fill_fence;
+
+/* SCREEN 5-8: filled run whose child spans are queued during the next SRCH */
+static uint8_t paint_run_on;
+static uint8_t paint_run_y;
+static int8_t paint_run_dy;
+static int16_t paint_run_x1;
+static int16_t paint_run_x2;
+static int16_t paint_run_px2;       /* End of the parent span */
+
+/* Pixel may be filled: neither border nor already painted */
+#define PAINT_INSIDE(c) ((c) != paint_border && (c) != paint_color)
+
+/* Queue exploration of line y + dy for parent span x1..x2 on line y */
+static void paint_push(int16_t y, int16_t x1, int16_t x2, int8_t dy) {
+    int16_t ny = y + dy;
+
+    if (ny < paint_min_y || ny > paint_max_y) return;
+    if (paint_sp >= paint_cap) {
+        paint_overflow = 1;
+        return;
+    }
+    paint_stack[paint_sp].x1 = x1;
+    paint_stack[paint_sp].x2 = x2;
+    paint_stack[paint_sp].y = (uint8_t)ny;
+    paint_stack[paint_sp].dy = dy;
+    paint_sp++;
+}
+
+/* Fill x1..x2 on line y in one operation */
+static void paint_span(int16_t x1, int16_t x2, int16_t y) {
+    if (paint_mode >= 5 && paint_mode <= 12) {
+        if (dirty_on) dirty_add(x1, y, x2, y);
+        vdp_fill((uint16_t)x1, (uint16_t)y + paint_page_y,
+                 (uint16_t)(x2 - x1 + 1), 1, paint_fill_color);
+        paint_fill_y = y;
+        paint_fill_x1 = x1;
+        paint_fill_x2 = x2;
+        paint_fill_fence = vdp_fence();
+    } else {
+        scr2_fill(x1, y, x2, y, paint_color);
+    }
+}
+
+/* Read one bitmap pixel on the active page; waits only when the last
+ * queued fill covers it (the VDP may keep searching or filling) */
+static uint8_t paint_pixel(int16_t x, int16_t y) {
+    uint8_t b;
+
+    if (y == paint_fill_y && x >= paint_fill_x1 && x <= paint_fill_x2) {
+        vdp_fence_wait(paint_fill_fence);
+        paint_fill_y = -1;
+    }
+    bitmap_set_read(x, y, paint_mode);
+    b = vram_get();
+    vram_close();
+    return bitmap_pixel(b, x, paint_mode);
+}
+
+/* Queue the children of the last filled run */
+static void paint_run_push(void) {
+    if (!paint_run_on) return;
+    paint_run_on = 0;
+    paint_push(paint_run_y, paint_run_x1, paint_run_x2, paint_run_dy);
+    if (paint_run_x2 > paint_run_px2) {
+        paint_push(paint_run_y, paint_run_px2 + 1, paint_run_x2, -paint_run_dy);
+    }
+}
+
+/* Complete a border search started with vdp_search_start(); if the fill
+ * color differs from the border, search for it too and take the nearer.
+ * Pending child spans are queued while the VDP searches.
+ * Returns the stop X, limited to paint_min_x - 1 or paint_max_x + 1. */
+static int16_t paint_srch_end(int16_t x, uint16_t vy, uint8_t dir) {
+    int16_t a, b;
+
+    paint_run_push();
+    a = vdp_search_result();
+
+    /* A border right at x is nearest whatever the second search finds */
+    if (paint_color != paint_border && a != x) {
+        b = vdp_search((uint16_t)x, vy, paint_color, dir);
+        if (a < 0) {
+            a = b;
+        } else if (b >= 0) {
+            if (dir == VDP_SRCH_LEFT) {
+                if (b > a) a = b;
+            } else {
+                if (b < a) a = b;
             }
         }
+    }
+    if (dir == VDP_SRCH_LEFT) {
+        return (a < paint_min_x) ? paint_min_x - 1 : a;
+    }
+    return (a < 0 || a > paint_max_x) ? paint_max_x + 1 : a;
+}
 
-        /* Fill the scanline from lx to rx */
-        {
-            int16_t fx;
-            for (fx = lx; fx <= rx; fx++) {
-                uint8_t c = basic_point(fx, ny);
-                if (c != border && c != color) {
-                    basic_pset(fx, ny, color);
-                }
-            }
+/* SCREEN 5-8 engine: span ends via VDP SRCH */
+static void paint_run_srch(void) {
+    int16_t x, x1, x2, l, y;
+    int8_t dy;
+    uint16_t vy;
+    uint8_t p;
+    PaintSpan* sp;
+
+    while (paint_sp > 0) {
+        paint_sp--;
+        sp = &paint_stack[paint_sp];
+        x1 = sp->x1;
+        x2 = sp->x2;
+        y = sp->y;
+        dy = sp->dy;
+        vy = (uint16_t)y + paint_page_y;
+
+        if (!PAINT_INSIDE(paint_pixel(x1, y))) {
+            x = x1;
+            goto skip;
         }
 
-        /* Push spans for next scanline */
-        if (lx < x1) {
-            paint_push(lx, x1 - 1, ny, -dy);
+        /* Extend left from x1 */
+        vdp_search_start((uint16_t)x1, vy, paint_border, VDP_SRCH_LEFT);
+        l = paint_srch_end(x1, vy, VDP_SRCH_LEFT) + 1;
+        x = x1 + 1;
+
+        /* Start the right search, queue the left leak while it runs */
+        if (x <= paint_max_x) {
+            vdp_search_start((uint16_t)x, vy, paint_border, VDP_SRCH_RIGHT);
         }
-        if (rx > x2) {
-            paint_push(x2 + 1, rx, ny, -dy);
+        if (l < x1) paint_push(y, l, x1 - 1, -dy);
+
+        do {
+            /* Extend right, then fill the whole run at once */
+            if (x <= paint_max_x) {
+                x = paint_srch_end(x, vy, VDP_SRCH_RIGHT);
+            }
+            paint_span(l, x - 1, y);
+
+            /* Its child spans are queued during the next SRCH */
+            paint_run_push();
+            paint_run_on = 1;
+            paint_run_y = (uint8_t)y;
+            paint_run_dy = dy;
+            paint_run_x1 = l;
+            paint_run_x2 = x - 1;
+            paint_run_px2 = x2;
+skip:
+            /* Skip whole runs of non-fillable pixels under the parent span */
+            for (x++; x <= x2; ) {
+                p = paint_pixel(x, y);
+                if (PAINT_INSIDE(p)) break;
+                x = vdp_search((uint16_t)x, vy, p, VDP_SRCH_RIGHT | VDP_SRCH_NE);
+                if (x < 0 || x > paint_max_x) x = paint_max_x + 1;
+            }
+            /* l is fillable: start the next right search from l + 1 */
+            l = x++;
+            if (l <= x2 && x <= paint_max_x) {
+                vdp_search_start((uint16_t)x, vy, paint_border, VDP_SRCH_RIGHT);
+            }
+        } while (l <= x2);
+        paint_run_push();
+    }
+}
+
+/* Scanline-cache engine: span ends found in a RAM copy of the line */
+static void paint_run_cache(uint8_t* line) {
+    int16_t x, x1, x2, l, y, fx;
+    int16_t cy = -1;
+    int8_t dy;
+    PaintSpan* sp;
+
+    while (paint_sp > 0) {
+        paint_sp--;
+        sp = &paint_stack[paint_sp];
+        x1 = sp->x1;
+        x2 = sp->x2;
+        y = sp->y;
+        dy = sp->dy;
+        /* Load the scanline into the cache with one bulk read */
+        if (y != cy) {
+            if (paint_mode >= 5) vdp_flush();
+            basic_point_row(paint_min_x, y, paint_max_x - paint_min_x + 1,
+                            line + paint_min_x);
+            cy = y;
         }
-        paint_push(lx, rx, ny, dy);
+
+        /* Extend left from x1 */
+        x = x1;
+        while (x >= paint_min_x && PAINT_INSIDE(line[x])) x--;
+        if (x >= x1) goto skip;
+        l = x + 1;
+        if (l < x1) paint_push(y, l, x1 - 1, -dy);
+        x = x1 + 1;
+
+        do {
+            /* Extend right, then fill the whole run at once */
+            while (x <= paint_max_x && PAINT_INSIDE(line[x])) x++;
+            for (fx = l; fx < x; fx++) line[fx] = paint_color;
+            paint_span(l, x - 1, y);
+
+            paint_push(y, l, x - 1, dy);
+            if (x > x2 + 1) paint_push(y, x2 + 1, x - 1, -dy);
+skip:
+            /* Skip to the next fillable pixel under the parent span */
+            for (x++; x <= x2 && !PAINT_INSIDE(line[x]); x++);
+            l = x;
+        } while (x <= x2);
     }
 }
 
+void basic_paint(int16_t x, int16_t y, uint8_t color, uint8_t border) {
+    basic_paint_ex(x, y, color, border, paint_arena, sizeof(paint_arena));
+}
+
+uint8_t basic_paint_ex(int16_t x, int16_t y, uint8_t color, uint8_t border,
+                       uint8_t* arena, uint16_t arena_size) {
+    uint8_t mode = clip_update();
+    uint8_t srch = (mode >= 5 && mode <= 8);
+    uint16_t cache;
+    uint8_t target_color;
+
+    /* The fill stays inside the viewport */
+    paint_min_x = clip_x1;
+    paint_min_y = clip_y1;
+    paint_max_x = clip_x2;
+    paint_max_y = clip_y2;
+
+    /* Bounds check */
+    if (x < paint_min_x || x > paint_max_x || y < paint_min_y || y > paint_max_y) return 0;
+
+    /* Arena: scanline cache indexed by X (not needed with SRCH), then span stack */
+    cache = srch ? 0 : (uint16_t)(paint_max_x + 1);
+    if (arena_size < cache + sizeof(PaintSpan)) return 1;
+    paint_stack = (PaintSpan*)(arena + cache);
+    paint_cap = (arena_size - cache) / sizeof(PaintSpan);
+    paint_sp = 0;
+    paint_overflow = 0;
+
+    /* Compare colors at the mode's pixel depth (SRCH does the same) */
+    if (mode == 6) {
+        color &= 0x03;
+        border &= 0x03;
+    } else if (mode < 8 || mode > 12) {
+        color &= 0x0F;
+        border &= 0x0F;
+    }
+
+    /* Get the color at starting point */
+    target_color = basic_point(x, y);
+
+    /* Don't fill if starting point is already the fill color or border */
+    if (target_color == color || target_color == border) return 0;
+
+    paint_mode = mode;
+    paint_color = color;
+    paint_border = border;
+    paint_fill_color = (mode == 6) ? pack_color_screen6(color) : color;
+    paint_page_y = (mode >= 5 && mode <= 12) ? acpage_y(mode) : 0;
+    paint_fill_y = -1;
+    paint_run_on = 0;
+
+    /* Seed segment (popped first) and the line below it */
+    paint_push(y, x, x, 1);
+    paint_push(y + 1, x, x, -1);
+
+    if (srch) {
+        paint_run_srch();
+    } else {
+        paint_run_cache(arena);
+    }
+
+    return paint_overflow;
+}
+
+#undef PAINT_INSIDE
+
 void basic_paint_c(int16_t x, int16_t y, uint8_t color) {
     basic_paint(x, y, color, color);
 }
 
-void basic_draw(const char* cmd) {
-    int16_t x = sys_read16(GRPACX);
-    int16_t y = sys_read16(GRPACY);
-    uint8_t color = sys_read8(FORCLR);
-    uint8_t pen_down = 1;
-    uint8_t no_update = 0;  /* N prefix: don't update position */
+/* === Affine transform ===
+ * 8.8 fixed-point matrix for transformed DRAW replay and polylines.
+ * Every vertex is transformed once; the segments go to basic_line(). */
+static int16_t xf_m00 = 256, xf_m01 = 0, xf_m10 = 0, xf_m11 = 256;
+static int16_t xf_tx = 0, xf_ty = 0;
+
+/* sin(deg) * 256 for any angle in degrees */
+static int16_t xf_sin(int16_t deg) {
+    deg %= 360;
+    if (deg < 0) deg += 360;
+    if (deg <= 90) return (int16_t)sin_table[deg];
+    if (deg <= 180) return (int16_t)sin_table[180 - deg];
+    if (deg <= 270) return -(int16_t)sin_table[deg - 180];
+    return -(int16_t)sin_table[360 - deg];
+}
+
+static void xf_apply(int16_t x, int16_t y, int16_t* ox, int16_t* oy) {
+    *ox = xf_tx + (int16_t)(((int32_t)xf_m00 * x + (int32_t)xf_m01 * y + 128) >> 8);
+    *oy = xf_ty + (int16_t)(((int32_t)xf_m10 * x + (int32_t)xf_m11 * y + 128) >> 8);
+}
+
+void basic_xform(int16_t angle, uint16_t scale, int16_t tx, int16_t ty) {
+    int16_t sn, cs;
+
+    angle %= 360;
+    sn = (int16_t)(((int32_t)xf_sin(angle) * scale + 128) >> 8);
+    cs = (int16_t)(((int32_t)xf_sin(angle + 90) * scale + 128) >> 8);
+
+    /* Counterclockwise on screen, where Y grows downward */
+    xf_m00 = cs;
+    xf_m01 = sn;
+    xf_m10 = -sn;
+    xf_m11 = cs;
+    xf_tx = tx;
+    xf_ty = ty;
+}
+
+void basic_xform_reset(void) {
+    basic_xform(0, 256, 0, 0);
+}
+
+void basic_xform_point(int16_t* x, int16_t* y) {
+    xf_apply(*x, *y, x, y);
+}
+
+void basic_polyline(const int16_t* pts, uint8_t count, uint8_t color) {
+    int16_t x1, y1, x2, y2;
+
+    if (count == 0) return;
+    xf_apply(pts[0], pts[1], &x1, &y1);
+    if (count == 1) {
+        basic_pset(x1, y1, color);
+        return;
+    }
+    while (--count) {
+        pts += 2;
+        xf_apply(pts[0], pts[1], &x2, &y2);
+        basic_line(x1, y1, x2, y2, color);
+        x1 = x2;
+        y1 = y2;
+    }
+}
+
+/* === DRAW ===
+ * DRAW strings are parsed into pixel moves: S and A are folded into each
+ * move while parsing, so replaying a shape needs only additions and line
+ * calls. The parser either executes each op at once (basic_draw) or
+ * stores it as bytecode (basic_draw_compile, DRAW_OP_* in graphics.h). */
+
+static uint8_t draw_exec;       /* 1: execute ops while parsing */
+static uint8_t* draw_out;       /* Bytecode output (NULL: measure only) */
+static uint16_t draw_len;
+static uint16_t draw_cap;
+static int16_t draw_x, draw_y;  /* Pen while executing (model space) */
+static int16_t draw_sx, draw_sy;    /* Pen on screen */
+static uint8_t draw_xf;         /* 1: transform each vertex (basic_xform) */
+static uint8_t draw_color;
+static const uint8_t* draw_pc;  /* Bytecode read pointer */
+static int16_t draw_a, draw_b;  /* Operands of the fetched op */
+
+/* Execute one op on the pen */
+static void draw_do(uint8_t op, int16_t a, int16_t b) {
+    uint8_t kind = op & 0x0F;
+    int16_t nx, ny, sx, sy;
+
+    if (kind == DRAW_OP_COLOR) {
+        draw_color = (uint8_t)a;
+        return;
+    }
+
+    if (kind == DRAW_OP_MOVETO) {
+        nx = a;
+        ny = b;
+    } else {
+        nx = draw_x + a;
+        ny = draw_y + b;
+    }
+    if (draw_xf) {
+        xf_apply(nx, ny, &sx, &sy);
+    } else {
+        sx = nx;
+        sy = ny;
+    }
+    if (!(op & DRAW_FLAG_BLANK)) {
+        basic_line(draw_sx, draw_sy, sx, sy, draw_color);
+    }
+    if (kind == DRAW_OP_MOVETO || !(op & DRAW_FLAG_NOUPDATE)) {
+        draw_x = nx;
+        draw_y = ny;
+        draw_sx = sx;
+        draw_sy = sy;
+    }
+}
+
+/* Decode the next bytecode op into draw_a/draw_b; MOVE8 becomes MOVE */
+static uint8_t draw_fetch(void) {
+    uint8_t op = *draw_pc++;
+    const uint8_t* p = draw_pc;
+
+    switch (op & 0x0F) {
+        case DRAW_OP_END:
+            return op;
+        case DRAW_OP_MOVE8:
+            draw_a = (int8_t)p[0];
+            draw_b = (int8_t)p[1];
+            draw_pc += 2;
+            return (op & 0xF0) | DRAW_OP_MOVE;
+        case DRAW_OP_COLOR:
+            draw_a = p[0];
+            draw_b = 0;
+            draw_pc += 1;
+            return op;
+        default:
+            draw_a = (int16_t)(p[0] | ((uint16_t)p[1] << 8));
+            draw_b = (int16_t)(p[2] | ((uint16_t)p[3] << 8));
+            draw_pc += 4;
+            return op;
+    }
+}
+
+/* Replay bytecode from the current pen and set the graphics cursor */
+static void draw_replay(const uint8_t* code) {
+    uint8_t op;
+
+    draw_color = sys_read8(FORCLR);
+    draw_pc = code;
+    while ((op = draw_fetch()) != DRAW_OP_END) {
+        draw_do(op, draw_a, draw_b);
+    }
+
+    sys_write16(GRPACX, draw_sx);
+    sys_write16(GRPACY, draw_sy);
+}
+
+static void draw_put(uint8_t v) {
+    if (draw_out && draw_len < draw_cap) draw_out[draw_len] = v;
+    draw_len++;
+}
+
+static void draw_put16(int16_t v) {
+    draw_put((uint8_t)v);
+    draw_put((uint8_t)((uint16_t)v >> 8));
+}
+
+/* Execute or store one op */
+static void draw_op(uint8_t op, int16_t a, int16_t b) {
+    if (draw_exec) {
+        draw_do(op, a, b);
+        return;
+    }
+    if ((op & 0x0F) == DRAW_OP_MOVE &&
+        a >= -128 && a <= 127 && b >= -128 && b <= 127) {
+        /* Short move */
+        draw_put((op & 0xF0) | DRAW_OP_MOVE8);
+        draw_put((uint8_t)a);
+        draw_put((uint8_t)b);
+        return;
+    }
+    draw_put(op);
+    if ((op & 0x0F) == DRAW_OP_COLOR) {
+        draw_put((uint8_t)a);
+    } else {
+        draw_put16(a);
+        draw_put16(b);
+    }
+}
+
+/* Parse a DRAW string into draw_op() calls */
+static void draw_parse(const char* cmd) {
+    uint8_t flags = 0;      /* DRAW_FLAG_BLANK (B) / DRAW_FLAG_NOUPDATE (N) */
     uint8_t angle = 0;      /* A0-3: rotation (0=0, 1=90, 2=180, 3=270) */
     int16_t scale = 4;      /* S1-255: scale factor (4 = default, means 1:1) */
     int16_t dist;
@@ -802,41 +2048,34 @@ void basic_draw(const char* cmd) {
 
         dx = 0;
         dy = 0;
+        if (dist == 0) dist = 1;
 
         switch (c) {
             case 'U': case 'u':
-                if (dist == 0) dist = 1;
                 dy = -(dist * scale) / 4;
                 break;
             case 'D': case 'd':
-                if (dist == 0) dist = 1;
                 dy = (dist * scale) / 4;
                 break;
             case 'L': case 'l':
-                if (dist == 0) dist = 1;
                 dx = -(dist * scale) / 4;
                 break;
             case 'R': case 'r':
-                if (dist == 0) dist = 1;
                 dx = (dist * scale) / 4;
                 break;
             case 'E': case 'e':
-                if (dist == 0) dist = 1;
                 dx = (dist * scale) / 4;
                 dy = -(dist * scale) / 4;
                 break;
             case 'F': case 'f':
-                if (dist == 0) dist = 1;
                 dx = (dist * scale) / 4;
                 dy = (dist * scale) / 4;
                 break;
             case 'G': case 'g':
-                if (dist == 0) dist = 1;
                 dx = -(dist * scale) / 4;
                 dy = (dist * scale) / 4;
                 break;
             case 'H': case 'h':
-                if (dist == 0) dist = 1;
                 dx = -(dist * scale) / 4;
                 dy = -(dist * scale) / 4;
                 break;
@@ -868,32 +2107,27 @@ void basic_draw(const char* cmd) {
                     dy = num2;
                 } else {
                     /* Absolute move: Mx,y */
-                    if (pen_down) {
-                        basic_line(x, y, num1, num2, color);
-                    }
-                    x = num1;
-                    y = num2;
-                    pen_down = 1;
-                    no_update = 0;
+                    draw_op(DRAW_OP_MOVETO | (flags & DRAW_FLAG_BLANK), num1, num2);
+                    flags = 0;
                     continue;
                 }
                 break;
             case 'B': case 'b':
-                pen_down = 0;
+                flags |= DRAW_FLAG_BLANK;
                 continue;
             case 'N': case 'n':
-                no_update = 1;
+                flags |= DRAW_FLAG_NOUPDATE;
                 continue;
             case 'C': case 'c':
-                color = (uint8_t)dist;
+                draw_op(DRAW_OP_COLOR, num1, 0);
                 continue;
             case 'A': case 'a':
                 /* Angle: 0=0, 1=90, 2=180, 3=270 degrees */
-                angle = (uint8_t)(dist & 3);
+                angle = (uint8_t)(num1 & 3);
                 continue;
             case 'S': case 's':
                 /* Scale: 1-255 (4 = default 1:1) */
-                if (dist > 0 && dist <= 255) scale = dist;
+                if (num1 > 0 && num1 <= 255) scale = num1;
                 continue;
             default:
                 continue;
@@ -913,28 +2147,53 @@ void basic_draw(const char* cmd) {
         }
 
         if (dx != 0 || dy != 0) {
-            int16_t new_x = x + dx;
-            int16_t new_y = y + dy;
+            draw_op(DRAW_OP_MOVE | flags, dx, dy);
+        }
+        flags = 0;
+    }
+}
 
-            if (pen_down) {
-                basic_line(x, y, new_x, new_y, color);
-            }
+void basic_draw(const char* cmd) {
+    draw_x = draw_sx = sys_read16(GRPACX);
+    draw_y = draw_sy = sys_read16(GRPACY);
+    draw_color = sys_read8(FORCLR);
+    draw_xf = 0;
+    draw_exec = 1;
+    draw_parse(cmd);
+
+    sys_write16(GRPACX, draw_sx);
+    sys_write16(GRPACY, draw_sy);
+}
 
-            if (!no_update) {
-                x = new_x;
-                y = new_y;
-            }
-        }
+uint16_t basic_draw_compile(const char* cmd, uint8_t* code, uint16_t size) {
+    draw_exec = 0;
+    draw_out = code;
+    draw_cap = size;
+    draw_len = 0;
+    draw_parse(cmd);
+    draw_put(DRAW_OP_END);
 
-        pen_down = 1;
-        no_update = 0;
-    }
+    if (code && draw_len > size) return 0;
+    return draw_len;
+}
 
-    sys_write16(GRPACX, x);
-    sys_write16(GRPACY, y);
+void basic_draw_run(const uint8_t* code, int16_t x, int16_t y) {
+    draw_x = draw_sx = x;
+    draw_y = draw_sy = y;
+    draw_xf = 0;
+    draw_replay(code);
+}
+
+void basic_draw_run_xform(const uint8_t* code) {
+    draw_x = 0;
+    draw_y = 0;
+    draw_xf = 1;
+    xf_apply(0, 0, &draw_sx, &draw_sy);
+    draw_replay(code);
 }
 
 uint8_t basic_point(int16_t x, int16_t y) {
+    uint8_t mode = sys_read8(SCRMOD);
     uint16_t pattern_num;
     uint16_t bank_offset;
     uint16_t pattern_addr;
@@ -943,6 +2202,24 @@ uint8_t basic_point(int16_t x, int16_t y) {
     uint8_t pattern_byte;
     uint8_t color_byte;
 
+    /* MSX2/MSX2+ bitmap modes: read the pixel byte directly (no VDP POINT) */
+    if (mode >= 5 && mode <= 12) {
+        int16_t max_x = (mode == 6 || mode == 7) ? 511 : 255;
+
+        if (x < 0 || x > max_x || y < 0 || y > 211) return 0;
+
+        /* Queued drawing commands must land first */
+        vdp_flush();
+        bitmap_set_read(x, y, mode);
+        color_byte = vram_get();
+        vram_close();
+
+        sys_write16(GRPACX, x);
+        sys_write16(GRPACY, y);
+
+        return bitmap_pixel(color_byte, x, mode);
+    }
+
     /* Bounds check */
     if (x < 0 || x > 255 || y < 0 || y > 191) return 0;
 
@@ -954,18 +2231,89 @@ uint8_t basic_point(int16_t x, int16_t y) {
 
     bit_pos = 7 - (x & 7);
 
-    pattern_byte = gfx_rdvrm(pattern_addr);
-    color_byte = gfx_rdvrm(color_addr);
+    pattern_byte = scr2_peek(pattern_addr);
+    color_byte = scr2_peek(color_addr);
+
+    sys_write16(GRPACX, x);
+    sys_write16(GRPACY, y);
+
+    /* Return foreground or background color based on pattern bit */
+    if (pattern_byte & (1 << bit_pos)) {
+        return (color_byte >> 4) & 0x0F;  /* foreground */
+    } else {
+        return color_byte & 0x0F;          /* background */
+    }
+}
+
+uint16_t basic_point_row(int16_t x, int16_t y, uint16_t count, uint8_t* buf) {
+    uint8_t mode = sys_read8(SCRMOD);
+    int16_t max_x, max_y;
+    uint16_t done;
+
+    if (mode == 6 || mode == 7) {
+        max_x = 511;
+    } else {
+        max_x = 255;
+    }
+    max_y = (mode >= 5 && mode <= 12) ? 211 : 191;
+
+    if (x < 0 || x > max_x || y < 0 || y > max_y) return 0;
+    if (count > (uint16_t)(max_x - x + 1)) count = (uint16_t)(max_x - x + 1);
+    if (count == 0) return 0;
+
+    /* MSX2/MSX2+ bitmap modes: one address setup, then stream the row */
+    if (mode >= 5 && mode <= 12) {
+        uint8_t tmp[32];
+        uint8_t shift = bitmap_ppb_shift(mode);
+        uint8_t mask = (1 << shift) - 1;
+        uint16_t left;
+        uint8_t i = 0, n = 0, b = 0;
+
+        vdp_flush();
+        bitmap_set_read(x, y, mode);
+
+        if (shift == 0) {
+            vram_read(buf, count);
+            vram_close();
+            return count;
+        }
+
+        /* Packed bytes covering the row */
+        left = (uint16_t)(((x + count - 1) >> shift) - (x >> shift) + 1);
 
-    sys_write16(GRPACX, x);
-    sys_write16(GRPACY, y);
+        for (done = 0; done < count; done++, x++) {
+            if (done == 0 || (x & mask) == 0) {
+                if (i == n) {
+                    n = (left > sizeof(tmp)) ? sizeof(tmp) : (uint8_t)left;
+                    vram_read(tmp, n);
+                    left -= n;
+                    i = 0;
+                }
+                b = tmp[i++];
+            }
+            buf[done] = bitmap_pixel(b, x, mode);
+        }
+        vram_close();
+        return count;
+    }
 
-    /* Return foreground or background color based on pattern bit */
-    if (pattern_byte & (1 << bit_pos)) {
-        return (color_byte >> 4) & 0x0F;  /* foreground */
-    } else {
-        return color_byte & 0x0F;          /* background */
+    /* SCREEN 2/4: one pattern/color read per 8x1 cell */
+    {
+        uint16_t addr;
+        uint8_t pattern_byte = 0;
+        uint8_t color_byte = 0;
+
+        for (done = 0; done < count; done++, x++) {
+            if (done == 0 || (x & 7) == 0) {
+                addr = ((uint16_t)(y >> 6) << 11) + ((uint16_t)((y >> 3) & 7) << 8)
+                     + ((uint16_t)(x >> 3) << 3) + (y & 7);
+                pattern_byte = scr2_peek(SCR2_PATTERN_BASE + addr);
+                color_byte = scr2_peek(SCR2_COLOR_BASE + addr);
+            }
+            buf[done] = (pattern_byte & (0x80 >> (x & 7))) ? (color_byte >> 4) : (color_byte & 0x0F);
+        }
     }
+    return count;
 }
 
 int16_t basic_grp_x(void) {
@@ -981,14 +2329,25 @@ void basic_grp_move(int16_t x, int16_t y) {
     sys_write16(GRPACY, y);
 }
 
-/* SCREEN 2/4 sprite tables (MSX1) */
+/* SCREEN 1-3 sprite tables (MSX1) */
 #define SCR2_SAT_BASE       0x1B00  /* Sprite Attribute Table */
 #define SCR2_SPG_BASE       0x3800  /* Sprite Pattern Generator */
 
-/* SCREEN 5-8 sprite tables (MSX2) */
+/* SCREEN 4 sprite tables (sprite mode 2) */
+#define SCR4_SAT_BASE       0x1E00  /* Sprite Attribute Table */
+
+/* SCREEN 5/6 sprite tables */
 #define SCR5_SAT_BASE       0x7600  /* Sprite Attribute Table */
 #define SCR5_SPG_BASE       0x7800  /* Sprite Pattern Generator */
 
+/* SCREEN 7-12 sprite tables */
+#define SCR7_SAT_BASE       0xFA00  /* Sprite Attribute Table */
+#define SCR7_SPG_BASE       0xF000  /* Sprite Pattern Generator */
+
+/* Sprite mode 2 (SCREEN 4 and up) keeps 16 color lines per plane in
+ * the 512 bytes below the SAT */
+#define SPRITE_CLR_SIZE     0x200
+
 #define SPRITE_OFF_Y        208     /* Y value to hide sprite (216 for MSX2) */
 
 /* System variable for sprite size */
@@ -1002,21 +2361,209 @@ static uint8_t get_sprite_size(void) {
 /* Get sprite attribute table base address based on screen mode */
 static uint16_t get_sat_base(void) {
     uint8_t mode = sys_read8(SCRMOD);
-    if (mode >= 5 && mode <= 8) {
-        return SCR5_SAT_BASE;
-    }
+    if (mode >= 7) return SCR7_SAT_BASE;
+    if (mode >= 5) return SCR5_SAT_BASE;
+    if (mode == 4) return SCR4_SAT_BASE;
     return SCR2_SAT_BASE;
 }
 
 /* Get sprite pattern generator base address based on screen mode */
 static uint16_t get_spg_base(void) {
     uint8_t mode = sys_read8(SCRMOD);
-    if (mode >= 5 && mode <= 8) {
-        return SCR5_SPG_BASE;
-    }
+    if (mode >= 7) return SCR7_SPG_BASE;
+    if (mode >= 5) return SCR5_SPG_BASE;
     return SCR2_SPG_BASE;
 }
 
+/* Shadow SAT: 32 entries of (Y, X, pattern, color) kept in RAM and
+ * uploaded in one burst. sat_lo/sat_hi bound the changed bytes. In
+ * sprite mode 2 the color table below the SAT is shadowed as well
+ * (sat_color, changed range sat_clo/sat_chi) and goes out in the same
+ * burst, so new colors never show before the attributes they go with. */
+static uint8_t sat_shadow[128];
+static uint8_t sat_color[SPRITE_CLR_SIZE];
+static uint8_t sat_buf;             /* SPRITE_BUF_*, 0 = write through */
+static uint8_t sat_lo = 128;        /* First changed byte */
+static uint8_t sat_hi;              /* One past the last changed byte */
+static uint16_t sat_clo = SPRITE_CLR_SIZE;  /* First changed color byte */
+static uint16_t sat_chi;            /* One past the last changed color byte */
+static uint16_t sat_vram;           /* VRAM address of the mirrored SAT */
+static uint8_t sat_r14;             /* R#14 value for sat_vram, 0xFF on MSX1 */
+static volatile uint8_t sat_busy;   /* Set while the program updates the shadow */
+
+/* Defined in system.c */
+extern uint8_t basic_timi_add(void (*fn)(void));
+extern void basic_timi_remove(void (*fn)(void));
+
+#asm
+
+; VBLANK routine (basic_timi_add): upload the changed part of the shadow
+; SAT. Skipped while the shadow is being updated or vram_open is set, so
+; streams started through the vram_* helpers keep their address. Streams
+; the program sets up on the ports itself are not seen (see vram_open).
+; R#14 is put back to vram_r14 afterwards.
+PUBLIC _sat_timi
+_sat_timi:
+    ld a, (_sat_busy)
+    ld hl, _vram_open
+    or (hl)
+    ret nz
+    ld hl, (_sat_chi)
+    ld de, (_sat_clo)
+    or a
+    sbc hl, de
+    jr c, sat_timi_1
+    jr z, sat_timi_1
+    ld b, l         ; B = bytes in the first pass (0 = 256)
+    ld a, l
+    or a
+    ld a, h
+    jr z, sat_timi_0
+    inc a
+sat_timi_0:
+    ld c, a         ; C = passes
+    push de
+    ld hl, (_sat_vram)
+    dec h
+    dec h           ; Color table = SAT - 0x200
+    add hl, de
+    ex de, hl       ; DE = VRAM address of the first changed byte
+    pop hl
+    push de
+    ld de, _sat_color
+    add hl, de
+    pop de
+    call sat_send
+    ld hl, 0x200    ; SPRITE_CLR_SIZE
+    ld (_sat_clo), hl
+    ld hl, 0
+    ld (_sat_chi), hl
+sat_timi_1:
+    ld a, (_sat_lo)
+    ld e, a
+    ld a, (_sat_hi)
+    sub e
+    ret c
+    ret z
+    ld b, a         ; B = byte count (1-128)
+    ld c, 1
+    ld d, 0
+    ld hl, (_sat_vram)
+    add hl, de
+    push hl
+    ld hl, _sat_shadow
+    add hl, de
+    pop de
+    call sat_send
+    ld a, 128
+    ld (_sat_lo), a
+    xor a
+    ld (_sat_hi), a
+    ret
+
+; Send C passes of B bytes (B = 0: 256; later passes 256) from HL to
+; VRAM address DE, then put R#14 back to the program's last value
+sat_send:
+    ld a, (_sat_r14)
+    inc a
+    jr z, sat_send_1
+    dec a
+    out (0x99), a
+    ld a, 0x80 + 14
+    out (0x99), a
+sat_send_1:
+    ld a, e
+    out (0x99), a
+    ld a, d
+    and 0x3F
+    or 0x40
+    out (0x99), a
+    ld e, c
+    ld c, 0x98
+sat_send_2:
+    outi
+    jp nz, sat_send_2
+    dec e
+    jp nz, sat_send_2
+    ld a, (_sat_r14)
+    inc a
+    ret z           ; MSX1: no R#14
+    ld a, (_vram_r14)
+    out (0x99), a
+    ld a, 0x80 + 14
+    out (0x99), a
+    ret
+
+#endasm
+
+extern void sat_timi(void);
+
+/* Extend the changed range of the shadow SAT */
+static void sat_mark(uint8_t off, uint8_t n) {
+    if (off < sat_lo) sat_lo = off;
+    if (off + n > sat_hi) sat_hi = off + n;
+}
+
+/* Same for the sprite mode 2 color table */
+static void sat_mark_color(uint16_t off, uint16_t n) {
+    if (off < sat_clo) sat_clo = off;
+    if (off + n > sat_chi) sat_chi = off + n;
+}
+
+void basic_sprite_flush(void) {
+    uint16_t clo, chi;
+    uint8_t lo, hi;
+
+    if (!sat_buf) return;
+
+    sat_busy = 1;
+    clo = sat_clo;
+    chi = sat_chi;
+    lo = sat_lo;
+    hi = sat_hi;
+    sat_clo = SPRITE_CLR_SIZE;
+    sat_chi = 0;
+    sat_lo = 128;
+    sat_hi = 0;
+    if (clo < chi) {
+        vram_ldirvm(sat_vram - SPRITE_CLR_SIZE + clo, sat_color + clo, chi - clo);
+    }
+    if (lo < hi) vram_ldirvm(sat_vram + lo, sat_shadow + lo, hi - lo);
+    sat_busy = 0;
+}
+
+void basic_sprite_buffer(uint8_t mode) {
+    /* Leaving VBLANK mode */
+    if (sat_buf == SPRITE_BUF_VBLANK && mode != SPRITE_BUF_VBLANK) {
+        basic_timi_remove(sat_timi);
+    }
+
+    /* Upload what is pending before changing mode */
+    basic_sprite_flush();
+
+    if (mode != SPRITE_BUF_OFF && sat_buf == SPRITE_BUF_OFF) {
+        /* Start from the table currently in VRAM */
+        sat_vram = get_sat_base();
+        sat_r14 = is_msx2() ? (uint8_t)(sat_vram >> 14) : 0xFF;
+        vram_ldirmv(sat_shadow, sat_vram, 128);
+        if (sys_read8(SCRMOD) >= 4) {
+            vram_ldirmv(sat_color, sat_vram - SPRITE_CLR_SIZE, SPRITE_CLR_SIZE);
+        }
+        sat_lo = 128;
+        sat_hi = 0;
+        sat_clo = SPRITE_CLR_SIZE;
+        sat_chi = 0;
+    }
+
+    /* No free VBLANK slot: stay with manual flushing */
+    if (mode == SPRITE_BUF_VBLANK && sat_buf != SPRITE_BUF_VBLANK &&
+        !basic_timi_add(sat_timi)) {
+        mode = SPRITE_BUF_MANUAL;
+    }
+
+    sat_buf = mode;
+}
+
 void basic_sprite_size(uint8_t size) {
     uint8_t rg1 = sys_read8(RG1SAV);
 
@@ -1049,29 +2596,24 @@ void basic_sprite_size(uint8_t size) {
 void basic_sprite_pattern(uint8_t pattern_num, const uint8_t* pattern) {
     uint16_t addr;
     uint8_t size;
-    uint8_t i;
 
     size = get_sprite_size();
     addr = get_spg_base() + (uint16_t)pattern_num * size;
 
-    for (i = 0; i < size; i++) {
-        gfx_wrtvrm_ext(addr + i, pattern[i]);
-    }
+    vram_ldirvm(addr, pattern, size);
 }
 
-void basic_put_sprite(uint8_t sprite_num, int16_t x, int16_t y, uint8_t color, uint8_t pattern) {
-    uint16_t sat_addr;
+/* Build one sprite attribute entry (Y, X, pattern, color+EC);
+ * size as returned by get_sprite_size() */
+static void sprite_attr(uint8_t* attr, uint8_t size, int16_t x, int16_t y,
+                        uint8_t color, uint8_t pattern) {
     uint8_t ec_bit = 0;
     uint8_t hw_pattern;
 
-    if (sprite_num > 31) return;
-
-    sat_addr = get_sat_base() + (uint16_t)sprite_num * 4;
-
     /* For 16x16 sprites, multiply pattern by 4.
      * Hardware ignores the 2 LSBs of the pattern number in 16x16 mode,
      * so pattern N must be written as N*4 to reference SPG + N*32. */
-    hw_pattern = (get_sprite_size() == 32) ? pattern * 4 : pattern;
+    hw_pattern = (size == 32) ? pattern * 4 : pattern;
 
     /* Handle negative X with Early Clock bit */
     if (x < 0) {
@@ -1080,10 +2622,42 @@ void basic_put_sprite(uint8_t sprite_num, int16_t x, int16_t y, uint8_t color, u
     }
 
     /* Write sprite attribute (Y, X, pattern, color+EC) */
-    gfx_wrtvrm_ext(sat_addr + 0, (uint8_t)(y - 1));  /* Y is offset by 1 in hardware */
-    gfx_wrtvrm_ext(sat_addr + 1, (uint8_t)x);
-    gfx_wrtvrm_ext(sat_addr + 2, hw_pattern);
-    gfx_wrtvrm_ext(sat_addr + 3, (color & 0x0F) | ec_bit);
+    attr[0] = (uint8_t)(y - 1);  /* Y is offset by 1 in hardware */
+    attr[1] = (uint8_t)x;
+    attr[2] = hw_pattern;
+    attr[3] = (color & 0x0F) | ec_bit;
+}
+
+/* Write one sprite attribute entry; sat_base and size as returned by
+ * get_sat_base() and get_sprite_size() */
+static void sprite_write(uint16_t sat_base, uint8_t size, uint8_t sprite_num,
+                         int16_t x, int16_t y, uint8_t color, uint8_t pattern) {
+    uint16_t sat_addr;
+    uint8_t* attr;
+    uint8_t buf[4];
+
+    sat_addr = sat_base + (uint16_t)sprite_num * 4;
+    if (sat_buf) {
+        sat_busy = 1;
+        attr = sat_shadow + sprite_num * 4;
+    } else {
+        attr = buf;
+    }
+
+    sprite_attr(attr, size, x, y, color, pattern);
+
+    if (sat_buf) {
+        sat_mark(sprite_num * 4, 4);
+        sat_busy = 0;
+    } else {
+        vram_ldirvm(sat_addr, attr, 4);
+    }
+}
+
+void basic_put_sprite(uint8_t sprite_num, int16_t x, int16_t y, uint8_t color, uint8_t pattern) {
+    if (sprite_num > 31) return;
+
+    sprite_write(get_sat_base(), get_sprite_size(), sprite_num, x, y, color, pattern);
 }
 
 void basic_sprite_off(uint8_t sprite_num) {
@@ -1091,17 +2665,37 @@ void basic_sprite_off(uint8_t sprite_num) {
 
     if (sprite_num > 31) return;
 
+    if (sat_buf) {
+        sat_busy = 1;
+        sat_shadow[sprite_num * 4] = SPRITE_OFF_Y;
+        sat_mark(sprite_num * 4, 1);
+        sat_busy = 0;
+        return;
+    }
+
     sat_addr = get_sat_base() + (uint16_t)sprite_num * 4;
-    gfx_wrtvrm_ext(sat_addr + 0, SPRITE_OFF_Y);  /* Y = 208 hides sprite */
+    vram_poke(sat_addr + 0, SPRITE_OFF_Y);  /* Y = 208 hides sprite */
 }
 
 void basic_sprites_off(void) {
+    uint16_t sat_addr;
     uint8_t i;
 
-    /* Hide all 32 sprites */
-    for (i = 0; i < 32; i++) {
-        basic_sprite_off(i);
+    /* Hide all 32 sprites: the Y bytes are 4 apart, so rewrite the whole
+     * table instead of setting the address 32 times. Unbuffered, the
+     * shadow is only scratch space. */
+    sat_busy = 1;
+    if (!sat_buf) {
+        sat_addr = get_sat_base();
+        vram_ldirmv(sat_shadow, sat_addr, 128);
     }
+    for (i = 0; i < 128; i += 4) sat_shadow[i] = SPRITE_OFF_Y;
+    if (sat_buf) {
+        sat_mark(0, 128);
+    } else {
+        vram_ldirvm(sat_addr, sat_shadow, 128);
+    }
+    sat_busy = 0;
 }
 
 uint8_t basic_sprite_collision(void) {
@@ -1111,36 +2705,176 @@ uint8_t basic_sprite_collision(void) {
     return (*(volatile uint8_t*)0xF3E7 & 0x20) ? 1 : 0;
 }
 
+/* === Sprite multiplexer ===
+ * Logical sprites are kept sorted by Y (insertion sort, cheap because
+ * the order changes little between frames) and assigned to hardware
+ * planes on every update. Runs of sprites that overlap vertically and
+ * put more than 4 (sprite mode 1) or 8 (mode 2) on a line are rotated
+ * each frame, so the VDP drops a different member every frame. */
+
+#define STATFL      0xF3E7  /* S#0 saved by the interrupt handler */
+#define SMUX_HIDDEN 0x7FFF  /* Y of a hidden logical sprite, sorts last */
+
+static int16_t smux_x[SMUX_MAX];
+static int16_t smux_y[SMUX_MAX];
+static uint8_t smux_color[SMUX_MAX];
+static uint8_t smux_pat[SMUX_MAX];
+static uint8_t smux_order[SMUX_MAX];    /* Logical sprites sorted by Y */
+static uint8_t smux_list[SMUX_MAX];     /* Plane order of this frame */
+static uint8_t smux_plane[32];          /* Logical sprite on each plane */
+static uint8_t smux_clr[32];            /* Sprite mode 2 color line per plane */
+static uint8_t smux_frame;
+
+void basic_smux_init(void) {
+    uint8_t i;
+
+    for (i = 0; i < SMUX_MAX; i++) {
+        smux_y[i] = SMUX_HIDDEN;
+        smux_order[i] = i;
+    }
+    for (i = 0; i < 32; i++) {
+        smux_plane[i] = 0xFF;
+        smux_clr[i] = 0xFF;
+    }
+    smux_frame = 0;
+}
+
+void basic_smux_set(uint8_t id, int16_t x, int16_t y, uint8_t color, uint8_t pattern) {
+    if (id >= SMUX_MAX) return;
+
+    smux_x[id] = x;
+    smux_y[id] = y;
+    smux_color[id] = color;
+    smux_pat[id] = pattern;
+}
+
+void basic_smux_hide(uint8_t id) {
+    if (id >= SMUX_MAX) return;
+
+    smux_y[id] = SMUX_HIDDEN;
+}
+
+uint8_t basic_smux_update(void) {
+    uint8_t mode = sys_read8(SCRMOD);
+    uint8_t size = get_sprite_size();
+    uint8_t limit = (mode >= 4) ? 8 : 4;
+    uint16_t sat = sat_buf ? sat_vram : get_sat_base();
+    int16_t h, y, end;
+    uint8_t hot = 0xFF;
+    uint8_t st, id, n, i, j, w, k, len, over, used;
+    uint8_t* attr;
+
+    /* Height on screen, doubled when magnified */
+    h = (size == 32) ? 16 : 8;
+    if (sys_read8(RG1SAV) & 0x01) h <<= 1;
+
+    /* The VDP saw a 5th (9th) sprite on a line last frame: its plane
+     * number is in S#0 bits 0-4 */
+    st = sys_read8(STATFL);
+    if (st & 0x40) hot = smux_plane[st & 0x1F];
+
+    /* Sort by Y; hidden sprites end up at the back */
+    for (i = 1; i < SMUX_MAX; i++) {
+        id = smux_order[i];
+        y = smux_y[id];
+        for (j = i; j && smux_y[smux_order[j - 1]] > y; j--) {
+            smux_order[j] = smux_order[j - 1];
+        }
+        smux_order[j] = id;
+    }
+    for (n = 0; n < SMUX_MAX && smux_y[smux_order[n]] != SMUX_HIDDEN; n++) {
+    }
+
+    /* Split into runs of vertically overlapping sprites and rotate the
+     * overloaded ones by one line's worth per frame */
+    smux_frame++;
+    for (i = 0; i < n; i = j) {
+        end = smux_y[smux_order[i]] + h;
+        over = (smux_order[i] == hot);
+        w = i;
+        for (j = i + 1; j < n && smux_y[smux_order[j]] < end; j++) {
+            y = smux_y[smux_order[j]];
+            /* w = first sprite still covering line y */
+            while (smux_y[smux_order[w]] + h <= y) w++;
+            if (j - w + 1 > limit || smux_order[j] == hot) over = 1;
+            if (y + h > end) end = y + h;
+        }
+        len = j - i;
+        k = over ? (uint8_t)(((uint16_t)smux_frame * limit) % len) : 0;
+        for (w = i; w < j; w++) {
+            smux_list[w] = smux_order[i + k];
+            if (++k == len) k = 0;
+        }
+    }
+
+    /* More than 32 visible: show a different window of 32 each frame */
+    used = (n > 32) ? 32 : n;
+    k = (n > 32) ? (uint8_t)(((uint16_t)smux_frame * 32) % n) : 0;
+
+    sat_busy = 1;
+    for (i = 0; i < used; i++) {
+        id = smux_list[k];
+        if (++k == n) k = 0;
+
+        attr = sat_shadow + i * 4;
+        sprite_attr(attr, size, smux_x[id], smux_y[id], smux_color[id], smux_pat[id]);
+        smux_plane[i] = id;
+
+        /* Sprite mode 2 takes colors from the color table below the SAT;
+         * rewrite a plane's 16 lines only when its color changes */
+        if (mode >= 4 && smux_clr[i] != attr[3]) {
+            smux_clr[i] = attr[3];
+            if (sat_buf) {
+                for (j = 0; j < 16; j++) sat_color[(uint16_t)i * 16 + j] = attr[3];
+                sat_mark_color((uint16_t)i * 16, 16);
+            } else {
+                vram_filvrm(sat - SPRITE_CLR_SIZE + (uint16_t)i * 16, 16, attr[3]);
+            }
+        }
+    }
+    for (i = used; i < 32; i++) smux_plane[i] = 0xFF;
+
+    /* Terminate the table after the last plane in use */
+    if (used < 32) sat_shadow[used * 4] = (mode >= 4) ? 216 : 208;
+    n = (used < 32) ? used * 4 + 1 : 128;
+
+    if (sat_buf) {
+        sat_mark(0, n);
+    } else {
+        vram_ldirvm(sat, sat_shadow, n);
+    }
+    sat_busy = 0;
+
+    return used;
+}
+
 void basic_copy(int16_t sx, int16_t sy, uint16_t width, uint16_t height,
                 int16_t dx, int16_t dy) {
+    uint16_t page;
+
     if (!is_msx2()) return;
-    vdp_copy((uint16_t)sx, (uint16_t)sy, (uint16_t)dx, (uint16_t)dy, width, height);
+    if (dirty_on) dirty_add(dx, dy, dx + width - 1, dy + height - 1);
+
+    /* Both areas are on the active page */
+    page = acpage_y(sys_read8(SCRMOD));
+    vdp_copy((uint16_t)sx, (uint16_t)sy + page, (uint16_t)dx, (uint16_t)dy + page, width, height);
 }
 
 void basic_copy_page(int16_t sx, int16_t sy, uint16_t width, uint16_t height,
                      uint8_t src_page, int16_t dx, int16_t dy, uint8_t dst_page) {
-    uint16_t page_height;
-    uint16_t sy_abs, dy_abs;
     uint8_t mode;
 
     if (!is_msx2()) return;
 
     mode = sys_read8(SCRMOD);
 
-    /* Calculate page height based on screen mode */
-    if (mode == 5 || mode == 6) {
-        page_height = 256;  /* 4 pages in 128KB */
-    } else if (mode == 7 || mode == 8) {
-        page_height = 256;  /* 2 pages in 128KB */
-    } else {
-        page_height = 212;  /* Default */
+    if (dirty_on && dst_page == sys_read8(ACPAGE)) {
+        dirty_add(dx, dy, dx + width - 1, dy + height - 1);
     }
 
-    /* Calculate absolute Y coordinates including page offset */
-    sy_abs = (uint16_t)sy + (src_page * page_height);
-    dy_abs = (uint16_t)dy + (dst_page * page_height);
-
-    vdp_copy((uint16_t)sx, sy_abs, (uint16_t)dx, dy_abs, width, height);
+    /* Absolute Y coordinates including the page offsets */
+    vdp_copy((uint16_t)sx, (uint16_t)sy + page_y(mode, src_page),
+             (uint16_t)dx, (uint16_t)dy + page_y(mode, dst_page), width, height);
 }
 
 void basic_set_page(uint8_t display_page, uint8_t active_page) {
@@ -1149,7 +2883,127 @@ void basic_set_page(uint8_t display_page, uint8_t active_page) {
     vdp_set_active_page(active_page);
 }
 
-/* === GET/PUT Graphics Block Operations === */
+/* === Double buffering (SCREEN 5-12) ===
+ * The front page is displayed while the primitives draw into the back
+ * page through ACPAGE. basic_dbuf_flip() shows the back page at VBLANK. */
+
+static uint8_t dbuf_front, dbuf_back;
+
+void basic_dbuf_init(uint8_t front, uint8_t back) {
+    if (!is_msx2()) return;
+    dbuf_front = front;
+    dbuf_back = back;
+    vdp_set_display_page(front);
+    vdp_set_active_page(back);
+}
+
+void basic_dbuf_flip(void) {
+    uint8_t page, jiffy;
+
+    if (!is_msx2()) return;
+
+    /* The back page must be complete before it is shown */
+    vdp_flush();
+
+    /* R#2 is written right after the VBLANK interrupt, before the
+     * first visible line is fetched. Wait for JIFFY to tick rather than
+     * for any interrupt, which a bare HALT would accept. */
+    jiffy = sys_read8(JIFFY);
+    while (sys_read8(JIFFY) == jiffy) {
+    }
+    vdp_set_display_page(dbuf_back);
+
+    page = dbuf_front;
+    dbuf_front = dbuf_back;
+    dbuf_back = page;
+    vdp_set_active_page(page);
+}
+
+void basic_dbuf_clear(uint8_t color) {
+    uint8_t mode = sys_read8(SCRMOD);
+    VdpCmd c;
+
+    if (!is_msx2() || mode < 5 || mode > 12) return;
+
+    /* HMMV writes whole bytes: repeat the color for every pixel in a byte */
+    if (mode == 6) {
+        color = pack_color_screen6(color);
+    } else if (mode == 5 || mode == 7) {
+        color = (uint8_t)((color << 4) | (color & 0x0F));
+    }
+
+    c.dx = 0;
+    c.dy = page_y(mode, dbuf_back);
+    c.nx = (mode == 6 || mode == 7) ? 512 : 256;
+    c.ny = 212;
+    c.clr = color;
+    c.arg = 0;
+    c.cmd = VDP_CMD_HMMV;
+    vdp_submit_dx(&c);
+}
+
+void basic_dbuf_restore(uint8_t src_page) {
+    uint8_t mode = sys_read8(SCRMOD);
+    VdpCmd c;
+
+    if (!is_msx2() || mode < 5 || mode > 12) return;
+
+    c.sx = 0;
+    c.sy = page_y(mode, src_page);
+    c.dx = 0;
+    c.dy = page_y(mode, dbuf_back);
+    c.nx = (mode == 6 || mode == 7) ? 512 : 256;
+    c.ny = 212;
+    c.clr = 0;
+    c.arg = 0;          /* Pages do not overlap */
+    c.cmd = VDP_CMD_HMMM;
+    vdp_submit(&c);
+}
+
+/* === GET/PUT Graphics Block Operations ===
+ * Buffer: 4-byte header (width, height) followed by packed rows, each row
+ * starting on a byte boundary, leftmost pixel in the high bits.
+ * SCREEN 5/7: 4 bpp, SCREEN 6: 2 bpp, SCREEN 8-12: 8 bpp (VRAM format).
+ * SCREEN 2/4: 1 bpp pattern bits (1 = foreground); colors are not stored. */
+
+/* Scratch row for LMMC pixel streaming */
+static uint8_t put_pixels[64];
+
+/* log2 of pixels per packed byte in the current mode */
+static uint8_t get_put_shift(uint8_t mode) {
+    if (mode >= 5 && mode <= 12) return bitmap_ppb_shift(mode);
+    return 3;
+}
+
+/* Pixel i of a packed 2/4/8 bpp row */
+static uint8_t packed_pixel(const uint8_t* row, uint16_t i, uint8_t shift) {
+    uint8_t b = row[i >> shift];
+
+    switch (shift) {
+        case 1:
+            return (i & 1) ? (b & 0x0F) : (b >> 4);
+        case 2:
+            return (b >> ((3 - (i & 3)) << 1)) & 0x03;
+        default:
+            return b;
+    }
+}
+
+/* 8 bits of a 1 bpp row starting at bit b (b >= -8); bits outside the row are 0 */
+static uint8_t packed_bits(const uint8_t* row, int16_t b, int16_t row_bytes) {
+    int16_t k = ((b + 8) >> 3) - 1;
+    uint8_t sh = (uint8_t)b & 7;
+    uint8_t hi = (k >= 0 && k < row_bytes) ? row[k] : 0;
+    uint8_t lo = (k + 1 < row_bytes) ? row[k + 1] : 0;
+
+    return (uint8_t)((hi << sh) | (lo >> (8 - sh)));
+}
+
+/* Pattern table address of pixel row y, cell 0 (SCREEN 2/4) */
+static uint16_t scr2_row_addr(int16_t y) {
+    return SCR2_PATTERN_BASE + ((uint16_t)(y >> 6) << 11) +
+           ((uint16_t)((y >> 3) & 7) << 8) + (y & 7);
+}
 
 uint16_t basic_get_size(uint16_t width, uint16_t height) {
     uint8_t mode = sys_read8(SCRMOD);
@@ -1167,6 +3021,9 @@ uint16_t basic_get_size(uint16_t width, uint16_t height) {
             bytes_per_line = (width + 1) / 2;
             break;
         case 8:  /* 256x212, 256 colors (8 bits/pixel) */
+        case 10:
+        case 11:
+        case 12:
             bytes_per_line = width;
             break;
         default: /* SCREEN 2/4: 1 bit/pixel */
@@ -1180,164 +3037,457 @@ uint16_t basic_get_size(uint16_t width, uint16_t height) {
 
 uint16_t basic_get(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t* buffer) {
     uint8_t mode = sys_read8(SCRMOD);
+    uint8_t msx2 = (mode >= 5 && mode <= 12);
+    uint8_t shift = get_put_shift(mode);
+    uint8_t ppb_mask = (1 << shift) - 1;
+    int16_t max_x, max_y;
     int16_t width, height;
-    int16_t x, y;
-    uint16_t offset;
+    int16_t y, i;
+    uint16_t row_bytes, src_bytes;
+    uint8_t sh, prev, next;
+    uint8_t* dest;
     int16_t tmp;
 
     /* Ensure x1 <= x2 and y1 <= y2 */
     if (x1 > x2) { tmp = x1; x1 = x2; x2 = tmp; }
     if (y1 > y2) { tmp = y1; y1 = y2; y2 = tmp; }
 
-    width = x2 - x1 + 1;
-    height = y2 - y1 + 1;
+    /* Clamp to the screen */
+    max_x = (mode == 6 || mode == 7) ? 511 : 255;
+    max_y = msx2 ? 211 : 191;
+    if (x1 < 0) x1 = 0;
+    if (y1 < 0) y1 = 0;
+    if (x2 > max_x) x2 = max_x;
+    if (y2 > max_y) y2 = max_y;
+    if (x1 > x2 || y1 > y2) {
+        width = 0;
+        height = 0;
+    } else {
+        width = x2 - x1 + 1;
+        height = y2 - y1 + 1;
+    }
 
     /* Store dimensions in header */
     buffer[0] = width & 0xFF;
     buffer[1] = (width >> 8) & 0xFF;
     buffer[2] = height & 0xFF;
     buffer[3] = (height >> 8) & 0xFF;
-    offset = 4;
-
-    /* For MSX2 modes, use VDP HMMC command would be optimal,
-     * but for simplicity, read pixel by pixel */
-    if (mode >= 5 && mode <= 8) {
-        for (y = y1; y <= y2; y++) {
-            for (x = x1; x <= x2; x++) {
-                buffer[offset++] = basic_point(x, y);
+    dest = buffer + 4;
+    if (height == 0) return 4;
+
+    /* Source bytes per row and bit offset of x1 within its byte */
+    row_bytes = ((uint16_t)width + ppb_mask) >> shift;
+    src_bytes = ((uint16_t)(x1 & ppb_mask) + width + ppb_mask) >> shift;
+    sh = (uint8_t)((x1 & ppb_mask) << (3 - shift));
+
+    if (msx2) vdp_flush();
+
+    for (y = y1; y <= y2; y++) {
+        if (msx2) {
+            /* Stream the row straight into the buffer when byte-aligned */
+            bitmap_set_read(x1, y, mode);
+            if (sh == 0) {
+                vram_read(dest, row_bytes);
+                vram_close();
+                dest += row_bytes;
+                continue;
             }
-        }
-    } else {
-        /* MSX1 modes: read pixel by pixel */
-        for (y = y1; y <= y2; y++) {
-            for (x = x1; x <= x2; x++) {
-                buffer[offset++] = basic_point(x, y);
+            prev = vram_get();
+            for (i = 1; i <= (int16_t)row_bytes; i++) {
+                next = (i < (int16_t)src_bytes) ? vram_get() : 0;
+                *dest++ = (uint8_t)((prev << sh) | (next >> (8 - sh)));
+                prev = next;
+            }
+            vram_close();
+        } else {
+            /* SCREEN 2/4: pattern bytes of a pixel row are 8 bytes apart */
+            uint16_t addr = scr2_row_addr(y) + ((x1 >> 3) << 3);
+
+            prev = scr2_peek(addr);
+            for (i = 1; i <= (int16_t)row_bytes; i++) {
+                addr += 8;
+                next = (i < (int16_t)src_bytes) ? scr2_peek(addr) : 0;
+                *dest++ = (uint8_t)((prev << sh) | (next >> (8 - sh)));
+                prev = next;
             }
         }
     }
 
-    return offset;
+    return (uint16_t)(dest - buffer);
 }
 
-void basic_put(int16_t x, int16_t y, const uint8_t* buffer, uint8_t op) {
-    uint16_t width, height;
-    int16_t dx, dy;
-    uint16_t offset;
-    uint8_t src_color, dst_color, result_color;
+/* PUT with the engine of the mode; clip_update() must have been called */
+static void put_draw(uint8_t mode, int16_t x, int16_t y, const uint8_t* buffer, uint8_t op) {
+    uint8_t msx2 = (mode >= 5 && mode <= 12);
+    uint8_t shift = get_put_shift(mode);
+    uint8_t ppb_mask = (1 << shift) - 1;
+    int16_t width, height, w, h, sx, sy;
+    int16_t r, i, k, n;
+    uint16_t row_bytes;
+    const uint8_t* data = buffer + 4;
+    const uint8_t* row;
 
     /* Read dimensions from header */
     width = buffer[0] | ((uint16_t)buffer[1] << 8);
     height = buffer[2] | ((uint16_t)buffer[3] << 8);
-    offset = 4;
-
-    for (dy = 0; dy < (int16_t)height; dy++) {
-        for (dx = 0; dx < (int16_t)width; dx++) {
-            src_color = buffer[offset++];
-
-            switch (op) {
-                case 0: /* PUT_PSET - Overwrite */
-                    basic_pset(x + dx, y + dy, src_color);
-                    break;
-
-                case 1: /* PUT_AND */
-                    dst_color = basic_point(x + dx, y + dy);
-                    result_color = src_color & dst_color;
-                    basic_pset(x + dx, y + dy, result_color);
-                    break;
-
-                case 2: /* PUT_OR */
-                    dst_color = basic_point(x + dx, y + dy);
-                    result_color = src_color | dst_color;
-                    basic_pset(x + dx, y + dy, result_color);
-                    break;
-
-                case 3: /* PUT_XOR */
-                    dst_color = basic_point(x + dx, y + dy);
-                    result_color = src_color ^ dst_color;
-                    basic_pset(x + dx, y + dy, result_color);
-                    break;
-
-                case 4: /* PUT_PRESET - Inverted */
-                    basic_pset(x + dx, y + dy, ~src_color & 0x0F);
-                    break;
+    row_bytes = ((uint16_t)width + ppb_mask) >> shift;
+    op &= 0x0F;
+
+    /* Clip to the viewport; (sx, sy) is the first visible source pixel */
+    sx = (x < clip_x1) ? clip_x1 - x : 0;
+    sy = (y < clip_y1) ? clip_y1 - y : 0;
+    w = width - sx;
+    h = height - sy;
+    if (x + width - 1 > clip_x2) w -= x + width - 1 - clip_x2;
+    if (y + height - 1 > clip_y2) h -= y + height - 1 - clip_y2;
+    if (w <= 0 || h <= 0) return;
+
+    if (msx2) {
+        uint16_t vy = (uint16_t)(y + sy) + acpage_y(mode);
+
+        if (dirty_on) dirty_add(x + sx, y + sy, x + sx + w - 1, y + sy + h - 1);
+
+        /* PSET of a whole, byte-aligned block: HMMC streams the packed rows */
+        if (op == PUT_PSET && w == width && h == height &&
+            !(x & ppb_mask) && !(width & ppb_mask)) {
+            const uint8_t* src = data + 1;
+            uint16_t left = row_bytes * h - 1;
+            uint16_t chunk;
+
+            vdp_xfer_start((uint16_t)x, vy, (uint16_t)w, (uint16_t)h, data[0], VDP_CMD_HMMC);
+            /* vdp_xfer_send runs with interrupts off: keep each DI
+             * section to 256 bytes so JIFFY, keys and hooks keep up */
+            for (; left; left -= chunk, src += chunk) {
+                chunk = (left > 256) ? 256 : left;
+                vdp_xfer_send(src, chunk);
+            }
+            return;
+        }
+
+        /* Otherwise LMMC with the matching logical operation, one pixel per byte */
+        row = data + (uint16_t)sy * row_bytes;
+        vdp_xfer_start((uint16_t)(x + sx), vy, (uint16_t)w, (uint16_t)h,
+                       packed_pixel(row, sx, shift), VDP_CMD_LMMC | op);
+        for (r = 0; r < h; r++) {
+            for (i = (r == 0) ? 1 : 0; i < w; i += n) {
+                n = w - i;
+                if (n > (int16_t)sizeof(put_pixels)) n = sizeof(put_pixels);
+                for (k = 0; k < n; k++) {
+                    put_pixels[k] = packed_pixel(row, sx + i + k, shift);
+                }
+                vdp_xfer_send(put_pixels, n);
             }
+            row += row_bytes;
         }
+        return;
     }
-}
 
-/* === Filled Circle and Ellipse === */
+    /* SCREEN 2/4: combine 1 bpp rows with the pattern bytes, cell by cell */
+    for (r = 0; r < h; r++) {
+        int16_t dy = y + sy + r;
+        int16_t px0 = x + sx;
+        int16_t px1 = px0 + w - 1;
+        int16_t c;
+        uint16_t addr = scr2_row_addr(dy) + ((px0 >> 3) << 3);
+
+        row = data + (uint16_t)(sy + r) * row_bytes;
+        for (c = px0 >> 3; c <= (px1 >> 3); c++, addr += 8) {
+            uint8_t m = 0xFF;
+            uint8_t src, d, res;
+
+            if (c == (px0 >> 3)) m &= 0xFF >> (px0 & 7);
+            if (c == (px1 >> 3)) m &= 0xFF << (7 - (px1 & 7));
+
+            /* Source bit of destination pixel p is p - x */
+            src = packed_bits(row, (c << 3) - x, row_bytes);
+            if (op & 0x08) m &= src;    /* Transparent: skip 0 bits */
+            if (m == 0) continue;
+
+            d = (m == 0xFF && (op & 0x07) == PUT_PSET) ? 0 : scr2_peek(addr);
+            switch (op & 0x07) {
+                case PUT_AND:    res = d & src; break;
+                case PUT_OR:     res = d | src; break;
+                case PUT_XOR:    res = d ^ src; break;
+                case PUT_PRESET: res = ~src; break;
+                default:         res = src; break;
+            }
+            scr2_poke(addr, (d & ~m) | (res & m));
+        }
+    }
+}
 
-void basic_circle_fill(int16_t x, int16_t y, int16_t radius, uint8_t color) {
-    int16_t cx = 0;
-    int16_t cy = radius;
-    int16_t d = 1 - radius;
+void basic_put(int16_t x, int16_t y, const uint8_t* buffer, uint8_t op) {
+    put_draw(clip_update(), x, y, buffer, op);
+}
 
-    while (cx <= cy) {
-        /* Draw horizontal lines for each y level */
-        basic_line(x - cx, y + cy, x + cx, y + cy, color);
-        basic_line(x - cx, y - cy, x + cx, y - cy, color);
-        basic_line(x - cy, y + cx, x + cy, y + cx, color);
-        basic_line(x - cy, y - cx, x + cy, y - cx, color);
+/* === Filled Circle and Ellipse === */
 
-        if (d < 0) {
-            d += 2 * cx + 3;
-        } else {
-            d += 2 * (cx - cy) + 5;
-            cy--;
+/* Fill ellipse (x, y, rx, ry) top to bottom, one span per row;
+ * clip_update() must have been called */
+static void conic_fill(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color) {
+    SpanRun* r = &span_run[0];
+    int16_t w, k, row, last;
+
+    if (rx < 0 || ry < 0) return;
+    if (clip_reject(x - rx, y - ry, x + rx, y + ry)) return;
+    run_color = color;
+    r->rows = 0;
+
+    if (ry == 0) {
+        run_add(r, x - rx, x + rx, y);
+    } else if (rx > CONIC_MAX_R || ry > CONIC_MAX_R) {
+        /* Huge radii: one square root per visible row */
+        row = (y - ry > clip_y1) ? y - ry : clip_y1;
+        last = (y + ry < clip_y2) ? y + ry : clip_y2;
+        for (; row <= last; row++) {
+            w = conic_width_big(rx, ry, (row < y) ? y - row : row - y);
+            run_add(r, x - w, x + w, row);
+        }
+    } else {
+        /* Upper half widens toward the center, lower half narrows */
+        conic_start(rx, ry);
+        for (k = ry; ; k--) {
+            w = conic_widen();
+            run_add(r, x - w, x + w, y - k);
+            if (k == 0) break;
+            conic_up();
+        }
+        for (k = 1; k <= ry; k++) {
+            w = conic_down();
+            run_add(r, x - w, x + w, y + k);
         }
-        cx++;
     }
+    run_flush(r);
+}
+
+void basic_circle_fill(int16_t x, int16_t y, int16_t radius, uint8_t color) {
+    clip_update();
+    conic_fill(x, y, radius, radius, color);
 
     sys_write16(GRPACX, x);
     sys_write16(GRPACY, y);
 }
 
 void basic_ellipse_fill(int16_t x, int16_t y, int16_t rx, int16_t ry, uint8_t color) {
-    int32_t rx2 = (int32_t)rx * rx;
-    int32_t ry2 = (int32_t)ry * ry;
-    int16_t cx = 0;
-    int16_t cy = ry;
-    int32_t px = 0;
-    int32_t py = 2 * rx2 * cy;
-    int32_t p;
+    clip_update();
+    conic_fill(x, y, rx, ry, color);
+
+    sys_write16(GRPACX, x);
+    sys_write16(GRPACY, y);
+}
 
-    /* Draw initial horizontal lines */
-    basic_line(x - rx, y, x + rx, y, color);
+/* === Display lists ===
+ * Primitives are recorded as an op byte followed by little-endian
+ * operands. Corners and arguments are validated while recording; the
+ * replay resolves the screen mode, clip rectangle, color packing and
+ * sprite table once and then calls the engines directly. */
+
+#define DL_OP_END       0x00
+#define DL_OP_PSET      0x01    /* x, y, color */
+#define DL_OP_LINE      0x02    /* x1, y1, x2, y2, color */
+#define DL_OP_BOX       0x03    /* x1, y1, x2, y2, color */
+#define DL_OP_BOXFILL   0x04    /* x1, y1, x2, y2 (normalized), color */
+#define DL_OP_COPY      0x05    /* sx, sy, width, height, dx, dy */
+#define DL_OP_PUT       0x06    /* x, y, buffer, op */
+#define DL_OP_SPRITE    0x07    /* plane, x, y, color, pattern */
+
+static uint8_t* dl_buf;
+static uint16_t dl_len;
+static uint16_t dl_cap;
+
+static void dl_put(uint8_t v) {
+    if (dl_len < dl_cap) dl_buf[dl_len] = v;
+    dl_len++;
+}
 
-    /* Region 1 */
-    p = ry2 - rx2 * ry + rx2 / 4;
-    while (px < py) {
-        cx++;
-        px += 2 * ry2;
-        if (p < 0) {
-            p += ry2 + px;
-        } else {
-            cy--;
-            py -= 2 * rx2;
-            p += ry2 + px - py;
-            /* Draw horizontal lines */
-            basic_line(x - cx, y + cy, x + cx, y + cy, color);
-            basic_line(x - cx, y - cy, x + cx, y - cy, color);
-        }
+static void dl_put16(int16_t v) {
+    dl_put((uint8_t)v);
+    dl_put((uint8_t)((uint16_t)v >> 8));
+}
+
+static int16_t dl_word(const uint8_t* p) {
+    return (int16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+/* Record an op with a rectangle or segment */
+static void dl_rect(uint8_t op, int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    dl_put(op);
+    dl_put16(x1);
+    dl_put16(y1);
+    dl_put16(x2);
+    dl_put16(y2);
+    dl_put(color);
+}
+
+void basic_dl_begin(uint8_t* buf, uint16_t size) {
+    dl_buf = buf;
+    dl_cap = size;
+    dl_len = 0;
+}
+
+uint16_t basic_dl_end(void) {
+    dl_put(DL_OP_END);
+    if (dl_len > dl_cap) {
+        /* Leave an empty list so that a replay draws nothing */
+        if (dl_cap) dl_buf[0] = DL_OP_END;
+        return 0;
     }
+    return dl_len;
+}
 
-    /* Region 2 */
-    p = ry2 * (cx + 1) * (cx + 1) / 4 + rx2 * (cy - 1) * (cy - 1) - rx2 * ry2;
-    while (cy >= 0) {
-        basic_line(x - cx, y + cy, x + cx, y + cy, color);
-        basic_line(x - cx, y - cy, x + cx, y - cy, color);
+void basic_dl_pset(int16_t x, int16_t y, uint8_t color) {
+    dl_put(DL_OP_PSET);
+    dl_put16(x);
+    dl_put16(y);
+    dl_put(color);
+}
 
-        cy--;
-        py -= 2 * rx2;
-        if (p > 0) {
-            p += rx2 - py;
-        } else {
-            cx++;
-            px += 2 * ry2;
-            p += rx2 - py + px;
+void basic_dl_line(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    dl_rect(DL_OP_LINE, x1, y1, x2, y2, color);
+}
+
+void basic_dl_box(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    dl_rect(DL_OP_BOX, x1, y1, x2, y2, color);
+}
+
+void basic_dl_boxfill(int16_t x1, int16_t y1, int16_t x2, int16_t y2, uint8_t color) {
+    int16_t tmp;
+
+    if (x1 > x2) { tmp = x1; x1 = x2; x2 = tmp; }
+    if (y1 > y2) { tmp = y1; y1 = y2; y2 = tmp; }
+    dl_rect(DL_OP_BOXFILL, x1, y1, x2, y2, color);
+}
+
+void basic_dl_copy(int16_t sx, int16_t sy, uint16_t width, uint16_t height,
+                   int16_t dx, int16_t dy) {
+    if (width == 0 || height == 0) return;
+
+    dl_put(DL_OP_COPY);
+    dl_put16(sx);
+    dl_put16(sy);
+    dl_put16((int16_t)width);
+    dl_put16((int16_t)height);
+    dl_put16(dx);
+    dl_put16(dy);
+}
+
+void basic_dl_put(int16_t x, int16_t y, const uint8_t* buffer, uint8_t op) {
+    if (!buffer) return;
+
+    dl_put(DL_OP_PUT);
+    dl_put16(x);
+    dl_put16(y);
+    dl_put16((int16_t)(uint16_t)buffer);
+    dl_put(op);
+}
+
+void basic_dl_sprite(uint8_t sprite_num, int16_t x, int16_t y, uint8_t color, uint8_t pattern) {
+    if (sprite_num > 31) return;
+
+    dl_put(DL_OP_SPRITE);
+    dl_put(sprite_num);
+    dl_put16(x);
+    dl_put16(y);
+    dl_put(color);
+    dl_put(pattern);
+}
+
+void basic_dl_execute(const uint8_t* dl, uint8_t vsync) {
+    uint8_t mode, msx2, pack6, op, color;
+    uint16_t sat;
+    uint8_t spr_size;
+    int16_t x1, y1, x2, y2;
+    int16_t gx = sys_read16(GRPACX);
+    int16_t gy = sys_read16(GRPACY);
+
+    /* Resolve everything that depends on the screen mode once */
+    mode = clip_update();
+    msx2 = (mode >= 5 && mode <= 12);
+    pack6 = (mode == 6);
+    sat = get_sat_base();
+    spr_size = get_sprite_size();
+
+    if (vsync) basic_wait_vblank();
+
+    for (;;) {
+        /* Stop at the end marker, or at an unknown op rather than
+         * misreading its operands */
+        op = *dl++;
+        if (op == DL_OP_END || op > DL_OP_SPRITE) break;
+
+        switch (op) {
+            case DL_OP_PSET:
+                x1 = dl_word(dl);
+                y1 = dl_word(dl + 2);
+                color = dl[4];
+                dl += 5;
+                if (msx2) {
+                    if (x1 >= clip_x1 && x1 <= clip_x2 && y1 >= clip_y1 && y1 <= clip_y2) {
+                        if (dirty_on) dirty_add(x1, y1, x1, y1);
+                        vdp_pset((uint16_t)x1, (uint16_t)y1 + clip_page_y,
+                                 pack6 ? pack_color_screen6(color) : color, VDP_LOG_IMP);
+                    }
+                } else {
+                    scr2_fill(x1, y1, x1, y1, color);
+                }
+                gx = x1;
+                gy = y1;
+                break;
+
+            case DL_OP_LINE:
+            case DL_OP_BOX:
+            case DL_OP_BOXFILL:
+                x1 = dl_word(dl);
+                y1 = dl_word(dl + 2);
+                x2 = dl_word(dl + 4);
+                y2 = dl_word(dl + 6);
+                color = dl[8];
+                dl += 9;
+                if (op == DL_OP_LINE) {
+                    line_draw(mode, x1, y1, x2, y2, color);
+                    gx = x2;
+                    gy = y2;
+                } else if (op == DL_OP_BOX) {
+                    box_draw(mode, x1, y1, x2, y2, color);
+                    gx = x1;
+                    gy = y1;
+                } else {
+                    /* Recorded normalized; the cursor moves as in basic_boxfill */
+                    fill_rect(x1, y1, x2, y2, color);
+                    if (!msx2) {
+                        gx = x2;
+                        gy = y2;
+                    }
+                }
+                break;
+
+            case DL_OP_COPY:
+                if (msx2) {
+                    if (dirty_on) {
+                        dirty_add(dl_word(dl + 8), dl_word(dl + 10),
+                                  dl_word(dl + 8) + dl_word(dl + 4) - 1,
+                                  dl_word(dl + 10) + dl_word(dl + 6) - 1);
+                    }
+                    vdp_copy((uint16_t)dl_word(dl), (uint16_t)dl_word(dl + 2) + clip_page_y,
+                             (uint16_t)dl_word(dl + 8), (uint16_t)dl_word(dl + 10) + clip_page_y,
+                             (uint16_t)dl_word(dl + 4), (uint16_t)dl_word(dl + 6));
+                }
+                dl += 12;
+                break;
+
+            case DL_OP_PUT:
+                put_draw(mode, dl_word(dl), dl_word(dl + 2),
+                         (const uint8_t*)(uint16_t)dl_word(dl + 4), dl[6]);
+                dl += 7;
+                break;
+
+            case DL_OP_SPRITE:
+                sprite_write(sat, spr_size, dl[0], dl_word(dl + 1), dl_word(dl + 3), dl[5], dl[6]);
+                dl += 7;
+                break;
         }
     }
 
-    sys_write16(GRPACX, x);
-    sys_write16(GRPACY, y);
+    sys_write16(GRPACX, gx);
+    sys_write16(GRPACY, gy);
 }
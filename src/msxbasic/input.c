@@ -10,12 +10,14 @@
 
 #include <stdint.h>
 #include "../../include/msxbasic/input.h"
+#include "../../include/msxbasic/vdp.h"
 
 #define CLIKSW 0xF3DB
 #define FNKSTR 0xF87F   /* Function key string area (10 keys * 16 bytes) */
 
 /* External assembly function from system.c */
 extern uint8_t sys_snsmat(uint8_t row);
+extern uint8_t basic_is_msx2(void);
 
 #asm
 
@@ -144,12 +146,20 @@ extern void inp_erafnk(void);
 extern uint8_t inp_gtpad(uint8_t pad);
 extern uint8_t inp_gtpdl(uint8_t paddle);
 
+/* Finish queued VDP commands before blocking on the keyboard (MSX2) */
+static void inp_sync(void) {
+    if (basic_is_msx2()) vdp_flush();
+}
+
 char basic_inkey(void) {
+    /* Polling loops issue one queued command per call */
+    vdp_pump();
     return inp_inkey();
 }
 
 void basic_input_str(char* buffer, uint8_t n) {
     uint8_t i;
+    inp_sync();
     for (i = 0; i < n; i++) {
         buffer[i] = inp_waitkey();
     }
@@ -159,6 +169,7 @@ void basic_input_str(char* buffer, uint8_t n) {
 void basic_input_line(char* buffer, uint8_t max_len) {
     uint8_t count = 0;
     char c;
+    inp_sync();
     while (count < max_len - 1) {
         c = inp_waitkey();
         if (c == 13) break;
@@ -242,6 +253,7 @@ void basic_out(uint16_t port, uint8_t value) {
 }
 
 char basic_wait_key(void) {
+    inp_sync();
     return inp_waitkey();
 }
 
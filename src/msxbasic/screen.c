@@ -25,6 +25,7 @@
 #define BAKCLR      0xF3EA
 #define BDRCLR      0xF3EB
 #define SCRMOD      0xFCAF
+#define ACPAGE      0xFAF6  /* Active page (MSX2) */
 #define CSRSW       0xFCA9
 #define GRPACX      0xFCB7  /* Graphics accumulator X (2 bytes) */
 #define GRPACY      0xFCB9  /* Graphics accumulator Y (2 bytes) */
@@ -45,11 +46,18 @@
 /* Initialize BIOS trampoline (defined in system.c) */
 extern void basic_init(void);
 
-/* VRAM fill (defined in system.c) */
-extern void sys_filvrm(uint16_t addr, uint16_t count, uint8_t value);
+/* Direct-port VRAM access (defined in vram.c) */
+extern void vram_filvrm(uint16_t addr, uint16_t count, uint8_t value);
+extern uint8_t vram_peek(uint16_t addr);
 
 /* VDP fill for MSX2+ bitmap modes (defined in vdp.c) */
 extern void vdp_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t color);
+extern void vdp_flush(void);
+
+/* Damage tracking and the SCREEN 2/4 RAM shadow (defined in graphics.c) */
+extern void basic_dirty_add(int16_t x1, int16_t y1, int16_t x2, int16_t y2);
+extern void basic_shadow_off(void);
+extern void basic_shadow_clear(void);
 
 /* BIOS call wrapper using Z88DK */
 extern void msx_bios_cls(void);
@@ -144,28 +152,33 @@ void basic_cls(void) {
             /* SCREEN 0: Fill name table with spaces */
             addr = sys_read16(TXTNAM);
             size = (uint16_t)sys_read8(LINLEN) * (uint16_t)sys_read8(CRTCNT);
-            sys_filvrm(addr, size, 0x20);
+            vram_filvrm(addr, size, 0x20);
             break;
         case 1:
             /* SCREEN 1: Fill name table with spaces */
             addr = sys_read16(T32NAM);
-            sys_filvrm(addr, 32 * 24, 0x20);
+            vram_filvrm(addr, 32 * 24, 0x20);
             break;
         case 2:
         case 4:
             /* SCREEN 2/4: Clear pattern generator (6144 bytes) */
             addr = sys_read16(GRPCGP);
-            sys_filvrm(addr, 6144, 0x00);
+            vram_filvrm(addr, 6144, 0x00);
+            /* Keep the RAM shadow (if any) in step with VRAM */
+            basic_shadow_clear();
             break;
         case 3:
             /* SCREEN 3 (multicolor): Clear pattern generator (1536 bytes) */
-            sys_filvrm(0x0000, 1536, 0x00);
+            vram_filvrm(0x0000, 1536, 0x00);
             break;
         default:
-            /* SCREEN 5-12 (MSX2 bitmap): Use VDP command engine */
+            /* SCREEN 5-12 (MSX2 bitmap): Use VDP command engine on the
+             * active page (4 pages in SCREEN 5/6, 2 in SCREEN 7-12) */
             if (mode >= 5 && mode <= 12) {
                 uint16_t width = (mode == 6 || mode == 7) ? 512 : 256;
-                vdp_fill(0, 0, width, 212, 0);
+                uint8_t page = sys_read8(ACPAGE) & ((mode == 5 || mode == 6) ? 3 : 1);
+                vdp_fill(0, (uint16_t)page << 8, width, 212, 0);
+                basic_dirty_add(0, 0, width - 1, 211);
             }
             break;
     }
@@ -177,6 +190,10 @@ void basic_cls(void) {
 
 void basic_screen(uint8_t mode) {
     basic_init();
+    /* Queued VDP commands belong to the old mode */
+    if (sys_read8(SCRMOD) >= 5) vdp_flush();
+    /* A SCREEN 2/4 RAM shadow does not survive the mode change */
+    basic_shadow_off();
     msx_bios_chgmod(mode);
     sys_write8(CSRSW, 0x00);  /* Hide cursor */
 }
@@ -424,25 +441,6 @@ static uint16_t get_name_table_addr(void) {
     }
 }
 
-/* Read VRAM using BIOS */
-static uint8_t read_vram(uint16_t addr) {
-    uint8_t result;
-    #asm
-        ld hl, 2
-        add hl, sp
-        ld e, (hl)
-        inc hl
-        ld d, (hl)
-        ex de, hl       ; HL = addr
-        push hl
-        ld hl, 0x004A
-        ld (0xC02C), hl
-        pop hl
-        call 0xC000     ; RDVRM via trampoline
-        ld l, a
-    #endasm
-}
-
 uint8_t basic_screen_char(uint8_t x, uint8_t y) {
     uint16_t addr;
     uint8_t width;
@@ -454,7 +452,7 @@ uint8_t basic_screen_char(uint8_t x, uint8_t y) {
     width = sys_read8(LINLEN);
     addr = get_name_table_addr() + (uint16_t)y * width + x;
 
-    return read_vram(addr);
+    return vram_peek(addr);
 }
 
 uint8_t basic_screen_char_attr(uint8_t x, uint8_t y, uint8_t* attr) {
@@ -0,0 +1,245 @@
+/*
+ * Copyright (c) UO Soft
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file scroll.c
+ * @brief Hardware scrolling implementation
+ *
+ * The refill copies are queued on the VDP command queue and drained
+ * before the scroll registers change at VBLANK.
+ */
+
+#include <stdint.h>
+#include "../../include/msxbasic/scroll.h"
+#include "../../include/msxbasic/vdp.h"
+
+#define SCRMOD      0xFCAF
+#define DPPAGE      0xFAF5  /* Display page (MSX2) */
+#define RG9SAV      0xFFE8  /* VDP register 9 shadow (MSX2) */
+#define RG23SAV     0xFFF6  /* VDP register 23 shadow (MSX2) */
+#define RG25SAV     0xFFFA  /* VDP register 25 shadow (MSX2+) */
+#define RG26SAV     0xFFFB  /* VDP register 26 shadow (MSX2+) */
+#define RG27SAV     0xFFFC  /* VDP register 27 shadow (MSX2+) */
+
+#define sys_read8(addr)        (*(volatile uint8_t*)(addr))
+#define sys_write8(addr, val)  (*(volatile uint8_t*)(addr) = (val))
+
+/* Defined in system.c */
+extern uint8_t basic_is_msx2(void);
+extern uint8_t basic_is_msx2plus(void);
+extern void basic_wait_vblank(void);
+
+static uint8_t hs_on;
+static uint8_t hs_src;          /* Source page */
+static uint8_t hs_flags;        /* HSCROLL_* */
+static uint16_t hs_x;           /* Current world position */
+
+static uint8_t vs_on;
+static uint8_t vs_fresh;        /* 1: nothing shown yet, fill the whole screen */
+static uint16_t vs_src;         /* VRAM line of world line 0 */
+static VscrollRowFn vs_row;     /* RAM row provider, or NULL for VRAM */
+static uint16_t vs_y;           /* Current world line */
+
+/* Write a VDP register and its BIOS shadow */
+static void scroll_reg(uint8_t reg, uint8_t value, uint16_t sav) {
+    vdp_write_reg(reg, value);
+    sys_write8(sav, value);
+}
+
+/* Line offset of page in SCREEN 5 (4 pages) or SCREEN 8/10-12 (2 pages) */
+static uint16_t scroll_page_y(uint8_t mode, uint8_t page) {
+    return (uint16_t)(page & ((mode == 5) ? 3 : 1)) << 8;
+}
+
+static void hscroll_regs(uint16_t x) {
+    /* Coarse offset moves left in 8-dot units, R#27 moves back right */
+    uint8_t r26 = (uint8_t)((x + 7) >> 3) & ((hs_flags & HSCROLL_2PAGE) ? 0x3F : 0x1F);
+
+    scroll_reg(26, r26, RG26SAV);
+    scroll_reg(27, (uint8_t)(0 - x) & 7, RG27SAV);
+}
+
+/* Queue HMMM copies of world columns a .. a+n-1 from the source page */
+static void hscroll_fill(uint16_t a, uint16_t n) {
+    uint8_t mode = sys_read8(SCRMOD);
+    uint8_t align = (mode == 5) ? 1 : 0;    /* HMMM moves whole bytes */
+    uint8_t dp = sys_read8(DPPAGE);
+    uint8_t src = hs_src;
+    uint16_t wrap = 255;
+    uint16_t c, x0, seg;
+    uint8_t half;
+    VdpCmd cmd;
+
+    if (hs_flags & HSCROLL_2PAGE) {
+        wrap = 511;
+        dp &= ~1;
+        src &= ~1;
+    }
+
+    cmd.ny = 212;
+    cmd.clr = 0;
+    cmd.arg = 0;
+    cmd.cmd = VDP_CMD_HMMM;
+
+    while (n) {
+        c = a & wrap;
+        x0 = c & 255;
+        half = (uint8_t)(c >> 8);
+        seg = 256 - x0;
+        if (seg > n) seg = n;
+
+        cmd.sx = x0 & ~align;
+        cmd.dx = cmd.sx;
+        cmd.nx = ((x0 + seg - 1) | align) - cmd.sx + 1;
+        cmd.sy = scroll_page_y(mode, src + half);
+        cmd.dy = scroll_page_y(mode, dp + half);
+        vdp_submit(&cmd);
+
+        a += seg;
+        n -= seg;
+    }
+}
+
+void hscroll_init(uint8_t src_page, uint8_t flags) {
+    uint8_t mode = sys_read8(SCRMOD);
+
+    if (!basic_is_msx2plus()) return;
+    if (mode != 5 && mode != 8 && (mode < 10 || mode > 12)) return;
+
+    hs_src = src_page;
+    hs_flags = flags & (HSCROLL_MASK | HSCROLL_2PAGE);
+    hs_x = 0;
+    hs_on = 1;
+
+    scroll_reg(25, (sys_read8(RG25SAV) & ~0x03) | hs_flags, RG25SAV);
+    hscroll_regs(0);
+}
+
+void hscroll_set(uint16_t x) {
+    int16_t delta = (int16_t)(x - hs_x);
+    uint16_t n;
+
+    if (!hs_on) return;
+
+    /* Newly exposed columns: right edge when moving right, left edge otherwise */
+    if (delta > 0) {
+        n = ((uint16_t)delta > 256) ? 256 : (uint16_t)delta;
+        hscroll_fill(x + 256 - n, n);
+    } else if (delta < 0) {
+        n = ((uint16_t)-delta > 256) ? 256 : (uint16_t)-delta;
+        hscroll_fill(x, n);
+    }
+
+    /* The copies must be complete before the columns are shown */
+    vdp_flush();
+    basic_wait_vblank();
+    hscroll_regs(x);
+    hs_x = x;
+}
+
+void hscroll_off(void) {
+    if (!hs_on) return;
+    hs_on = 0;
+    hs_flags = 0;
+    hscroll_regs(0);
+    scroll_reg(25, sys_read8(RG25SAV) & ~0x03, RG25SAV);
+}
+
+/* Fill world lines a .. a+n-1 into the ring on the display page */
+static void vscroll_fill(uint16_t a, uint16_t n) {
+    uint8_t mode = sys_read8(SCRMOD);
+    uint16_t ring = (uint16_t)(sys_read8(DPPAGE) & ((mode == 5 || mode == 6) ? 3 : 1)) << 8;
+    uint16_t vmask = (mode == 5 || mode == 6) ? 1023 : 511;
+    uint16_t width = (mode == 6 || mode == 7) ? 512 : 256;
+    uint16_t bytes = (mode == 5 || mode == 6) ? 128 : 256;
+    uint16_t s, seg;
+    const uint8_t* data;
+    VdpCmd cmd;
+
+    if (vs_row) {
+        /* One HMMC per line from the provider */
+        for (; n; n--, a++) {
+            data = vs_row(a);
+            vdp_xfer_start(0, ring + (a & 255), width, 1, data[0], VDP_CMD_HMMC);
+            vdp_xfer_send(data + 1, bytes - 1);
+        }
+        return;
+    }
+
+    cmd.sx = 0;
+    cmd.dx = 0;
+    cmd.nx = width;
+    cmd.clr = 0;
+    cmd.arg = 0;
+    cmd.cmd = VDP_CMD_HMMM;
+
+    /* Split where the canvas wraps or the ring wraps */
+    while (n) {
+        s = (vs_src + a) & vmask;
+        seg = 256 - (a & 255);
+        if (seg > vmask + 1 - s) seg = vmask + 1 - s;
+        if (seg > n) seg = n;
+
+        cmd.sy = s;
+        cmd.dy = ring + (a & 255);
+        cmd.ny = seg;
+        vdp_submit(&cmd);
+
+        a += seg;
+        n -= seg;
+    }
+}
+
+static void vscroll_start(uint16_t src_line, VscrollRowFn row) {
+    uint8_t mode = sys_read8(SCRMOD);
+
+    if (!basic_is_msx2() || mode < 5 || mode > 12) return;
+
+    vs_src = src_line;
+    vs_row = row;
+    vs_y = 0;
+    vs_fresh = 1;
+    vs_on = 1;
+}
+
+void vscroll_init(uint16_t src_line) {
+    vscroll_start(src_line, 0);
+}
+
+void vscroll_init_ram(VscrollRowFn row) {
+    vscroll_start(0, row);
+}
+
+void vscroll_set(uint16_t y) {
+    uint16_t lines = (sys_read8(RG9SAV) & 0x80) ? 212 : 192;
+    int16_t delta = (int16_t)(y - vs_y);
+    uint16_t n;
+
+    if (!vs_on) return;
+
+    /* New lines: bottom edge when moving down, top edge otherwise */
+    if (vs_fresh) {
+        vscroll_fill(y, lines);
+        vs_fresh = 0;
+    } else if (delta > 0) {
+        n = ((uint16_t)delta > lines) ? lines : (uint16_t)delta;
+        vscroll_fill(y + lines - n, n);
+    } else if (delta < 0) {
+        n = ((uint16_t)-delta > lines) ? lines : (uint16_t)-delta;
+        vscroll_fill(y, n);
+    }
+
+    /* The lines must be complete before they are shown */
+    vdp_flush();
+    basic_wait_vblank();
+    scroll_reg(23, (uint8_t)y, RG23SAV);
+    vs_y = y;
+}
+
+void vscroll_off(void) {
+    if (!vs_on) return;
+    vs_on = 0;
+    scroll_reg(23, 0, RG23SAV);
+}
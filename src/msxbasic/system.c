@@ -10,6 +10,8 @@
 
 #include <stdint.h>
 #include "../../include/msxbasic/system.h"
+#include "../../include/msxbasic/vram.h"
+#include "../../include/msxbasic/vdp.h"
 
 #define MSXVER 0x002D
 #define CSRSW  0xFCA9
@@ -24,44 +26,11 @@ static uint8_t cached_msx_ver = 0;
 
 #asm
 
-PUBLIC _sys_vpeek
-PUBLIC _sys_vpoke
 PUBLIC _sys_rdvdp
 PUBLIC _sys_halt
-PUBLIC _sys_filvrm
-PUBLIC _sys_ldirvm
-PUBLIC _sys_ldirmv
 PUBLIC _sys_snsmat
 PUBLIC _sys_calbas
 
-_sys_vpeek:
-    pop de
-    pop hl
-    push hl
-    push de
-    push hl
-    ld hl, 0x004A
-    ld (0xC02C), hl
-    pop hl
-    call 0xC000     ; RDVRM
-    ld l, a
-    ret
-
-_sys_vpoke:
-    pop de
-    pop hl
-    pop bc
-    push bc
-    push hl
-    push de
-    ld a, c
-    push hl
-    ld hl, 0x004D
-    ld (0xC02C), hl
-    pop hl
-    call 0xC000     ; WRTVRM
-    ret
-
 _sys_rdvdp:
     ld hl, 0x013E
     ld (0xC02C), hl
@@ -73,85 +42,6 @@ _sys_halt:
     halt
     ret
 
-; void sys_filvrm(uint16_t addr, uint16_t count, uint8_t value)
-; sccz80 stack: [ret][value][count][addr]
-; SP+2=value, SP+4=count, SP+6=addr
-; FILVRM: HL=addr, BC=count, A=value
-_sys_filvrm:
-    ld hl, 2
-    add hl, sp
-    ld a, (hl)      ; value
-    inc hl
-    inc hl
-    ld c, (hl)      ; count low
-    inc hl
-    ld b, (hl)      ; count high
-    inc hl
-    ld e, (hl)      ; addr low
-    inc hl
-    ld d, (hl)      ; addr high
-    ex de, hl       ; HL = addr
-    push hl
-    ld hl, 0x0056
-    ld (0xC02C), hl
-    pop hl
-    call 0xC000     ; FILVRM
-    ret
-
-; void sys_ldirvm(uint16_t dest, const uint8_t* src, uint16_t count)
-; sccz80 stack: [ret][count][src][dest]
-; SP+2=count, SP+4=src, SP+6=dest
-; LDIRVM: HL=RAM src, DE=VRAM dest, BC=count
-_sys_ldirvm:
-    ld hl, 2
-    add hl, sp
-    ld c, (hl)      ; count low
-    inc hl
-    ld b, (hl)      ; count high
-    inc hl
-    ld e, (hl)      ; src low (RAM)
-    inc hl
-    ld d, (hl)      ; src high
-    inc hl
-    push de         ; save RAM src
-    ld e, (hl)      ; dest low (VRAM)
-    inc hl
-    ld d, (hl)      ; dest high
-    pop hl          ; HL = RAM src, DE = VRAM dest
-    push hl
-    ld hl, 0x005C
-    ld (0xC02C), hl
-    pop hl
-    call 0xC000     ; LDIRVM
-    ret
-
-; void sys_ldirmv(uint8_t* dest, uint16_t src, uint16_t count)
-; sccz80 stack: [ret][count][src][dest]
-; SP+2=count, SP+4=src(VRAM), SP+6=dest(RAM)
-; LDIRMV: HL=VRAM src, DE=RAM dest, BC=count
-_sys_ldirmv:
-    ld hl, 2
-    add hl, sp
-    ld c, (hl)      ; count low
-    inc hl
-    ld b, (hl)      ; count high
-    inc hl
-    ld e, (hl)      ; src low (VRAM)
-    inc hl
-    ld d, (hl)      ; src high
-    inc hl
-    push de         ; save VRAM src
-    ld e, (hl)      ; dest low (RAM)
-    inc hl
-    ld d, (hl)      ; dest high
-    pop hl          ; HL = VRAM src, DE = RAM dest
-    push hl
-    ld hl, 0x0059
-    ld (0xC02C), hl
-    pop hl
-    call 0xC000     ; LDIRMV
-    ret
-
 ; uint8_t sys_snsmat(uint8_t row)
 ; sccz80 stack: [ret][row]
 ; SP+2=row
@@ -290,120 +180,10 @@ _sys_calslt:
     call 0xC000     ; CALSLT
     ret
 
-; uint8_t sys_vpeek_ex(uint16_t addr_low, uint16_t addr_high)
-; Read from extended VRAM (MSX2, 128KB)
-; sccz80 stack: [ret][addr_high][addr_low]
-; SP+2=addr_high, SP+4=addr_low
-; addr_high bit 0 = VRAM A16 (for 128KB)
-; addr_low bits 0-15 = VRAM A0-A15
-PUBLIC _sys_vpeek_ex
-_sys_vpeek_ex:
-    di
-    ; Calculate R#14 value from addr_high and high bits of addr_low
-    ld hl, 2
-    add hl, sp
-    ld a, (hl)      ; addr_high (bit 0 = A16)
-    ld c, a         ; save
-    ld hl, 4
-    add hl, sp
-    inc hl          ; point to high byte of addr_low
-    ld a, (hl)      ; bits 8-15 of address
-    ld b, a         ; save
-    ; R#14 = bits 14-16 of address
-    ; bit 14 = addr_low bit 14, bit 15 = addr_low bit 15, bit 16 = addr_high bit 0
-    srl a           ; shift right
-    srl a           ; now A has bits 14-15 in position 4-5
-    and 0x03        ; mask bits 14-15
-    ld d, a
-    ld a, c
-    and 0x01        ; bit 16
-    rlca
-    rlca            ; shift to bit 2
-    or d            ; combine
-    ; Set R#14
-    out (0x99), a
-    ld a, 0x80 + 14
-    out (0x99), a
-    ; Set read address (bits 0-13)
-    ld hl, 4
-    add hl, sp
-    ld a, (hl)      ; addr_low low byte
-    out (0x99), a
-    ld a, b         ; addr_low high byte
-    and 0x3F        ; mask to 14 bits
-    out (0x99), a   ; read mode (bit 6 = 0)
-    ; Read data
-    in a, (0x98)
-    ld l, a
-    ; Reset R#14
-    xor a
-    out (0x99), a
-    ld a, 0x80 + 14
-    out (0x99), a
-    ei
-    ret
-
-; void sys_vpoke_ex(uint8_t val, uint16_t addr_low, uint16_t addr_high)
-; Write to extended VRAM (MSX2, 128KB)
-; sccz80 stack: [ret][addr_high][addr_low][val]
-; SP+2=addr_high, SP+4=addr_low, SP+6=val
-PUBLIC _sys_vpoke_ex
-_sys_vpoke_ex:
-    di
-    ; Calculate R#14 value
-    ld hl, 2
-    add hl, sp
-    ld a, (hl)      ; addr_high
-    ld c, a
-    ld hl, 4
-    add hl, sp
-    inc hl
-    ld a, (hl)      ; high byte of addr_low
-    ld b, a
-    srl a
-    srl a
-    and 0x03
-    ld d, a
-    ld a, c
-    and 0x01
-    rlca
-    rlca
-    or d
-    ; Set R#14
-    out (0x99), a
-    ld a, 0x80 + 14
-    out (0x99), a
-    ; Set write address
-    ld hl, 4
-    add hl, sp
-    ld a, (hl)      ; addr_low low byte
-    out (0x99), a
-    ld a, b
-    and 0x3F
-    or 0x40         ; write mode
-    out (0x99), a
-    ; Get value and write
-    ld hl, 6
-    add hl, sp
-    ld a, (hl)      ; val
-    out (0x98), a
-    ; Reset R#14
-    xor a
-    out (0x99), a
-    ld a, 0x80 + 14
-    out (0x99), a
-    ei
-    ret
-
 #endasm
 
-extern uint8_t sys_vpeek(uint16_t addr);
-extern void sys_vpoke(uint16_t addr, uint8_t val);
 extern uint8_t sys_rdvdp(void);
 extern void sys_halt(void);
-extern void sys_filvrm(uint16_t addr, uint16_t count, uint8_t value);
-extern void sys_ldirvm(uint16_t dest, const uint8_t* src, uint16_t count);
-extern void sys_ldirmv(uint8_t* dest, uint16_t src, uint16_t count);
 extern uint8_t sys_snsmat(uint8_t row);
 extern void sys_calbas(uint16_t addr);
 extern uint8_t sys_breakx(void);
@@ -455,31 +235,35 @@ uint8_t basic_vdp_status_n(uint8_t reg) {
     if (reg > 9) return 0;
     return sys_rdvdp_n(reg);
 }
-uint8_t basic_vpeek(uint16_t address) { return sys_vpeek(address); }
-void basic_vpoke(uint16_t address, uint8_t value) { sys_vpoke(address, value); }
-/* Extern declarations for assembly extended VRAM functions */
-extern uint8_t sys_vpeek_ex(uint16_t addr_low, uint16_t addr_high);
-extern void sys_vpoke_ex(uint8_t val, uint16_t addr_low, uint16_t addr_high);
+/* Let queued VDP commands finish before direct VRAM access (MSX2) */
+static void vram_sync(void) {
+    if (cached_msx_ver >= 1) vdp_flush();
+}
+
+uint8_t basic_vpeek(uint16_t address) { vram_sync(); return vram_peek(address); }
+void basic_vpoke(uint16_t address, uint8_t value) { vram_sync(); vram_poke(address, value); }
 
 uint8_t basic_vpeek_ex(uint32_t address) {
     basic_init();
     /* MSX1: only 16KB VRAM */
     if (cached_msx_ver < 1) {
-        return sys_vpeek(address & 0x3FFF);
+        return vram_peek(address & 0x3FFF);
     }
-    /* MSX2: use assembly function for 128KB VRAM */
-    return sys_vpeek_ex((uint16_t)(address & 0xFFFF), (uint16_t)((address >> 16) & 0x01));
+    /* MSX2: 128KB VRAM via R#14 */
+    vram_sync();
+    return vram_peek_ex(address & 0x1FFFF);
 }
 
 void basic_vpoke_ex(uint32_t address, uint8_t value) {
     basic_init();
     /* MSX1: only 16KB VRAM */
     if (cached_msx_ver < 1) {
-        sys_vpoke(address & 0x3FFF, value);
+        vram_poke(address & 0x3FFF, value);
         return;
     }
-    /* MSX2: use assembly function for 128KB VRAM */
-    sys_vpoke_ex(value, (uint16_t)(address & 0xFFFF), (uint16_t)((address >> 16) & 0x01));
+    /* MSX2: 128KB VRAM via R#14 */
+    vram_sync();
+    vram_poke_ex(address & 0x1FFFF, value);
 }
 
 uint16_t basic_base(uint8_t n) {
@@ -496,19 +280,115 @@ uint16_t basic_base(uint8_t n) {
 }
 
 void basic_vram_fill(uint16_t address, uint8_t value, uint16_t count) {
-    sys_filvrm(address, count, value);
+    vram_sync();
+    vram_filvrm(address, count, value);
 }
 
 void basic_vram_write(uint16_t dest, const uint8_t* src, uint16_t count) {
-    sys_ldirvm(dest, src, count);
+    vram_sync();
+    vram_ldirvm(dest, src, count);
 }
 
 void basic_vram_read(uint8_t* dest, uint16_t src, uint16_t count) {
-    sys_ldirmv(dest, src, count);
+    vram_sync();
+    vram_ldirmv(dest, src, count);
 }
 
-void basic_wait_vblank(void) { sys_halt(); }
-void basic_wait_frames(uint16_t frames) { while (frames--) sys_halt(); }
+/* Queued VDP commands are issued only by later queue calls; finish them
+ * before the program blocks so nothing stays undrawn while it waits */
+void basic_wait_vblank(void) { vram_sync(); sys_halt(); }
+void basic_wait_frames(uint16_t frames) { vram_sync(); while (frames--) sys_halt(); }
+
+/* VBLANK routines: one H.TIMI patch shared by every library hook, so
+ * they can be added and removed in any order */
+#define H_TIMI      0xFD9F
+#define TIMI_SLOTS  4
+
+static void (*timi_fn[TIMI_SLOTS])(void);
+static uint8_t timi_old[5];     /* H.TIMI before the dispatcher, chained */
+static uint8_t timi_hooked;
+
+#asm
+
+; H.TIMI handler: call every routine in timi_fn, then the previous hook.
+; A = S#0 from the BIOS interrupt handler and is kept for the chain.
+PUBLIC _timi_dispatch
+_timi_dispatch:
+    push af
+    ld hl, _timi_fn
+    ld b, 4         ; TIMI_SLOTS
+timi_dispatch_1:
+    ld e, (hl)
+    inc hl
+    ld d, (hl)
+    inc hl
+    ld a, d
+    or e
+    jr z, timi_dispatch_2
+    push hl
+    push bc
+    ex de, hl
+    call timi_dispatch_3
+    pop bc
+    pop hl
+timi_dispatch_2:
+    djnz timi_dispatch_1
+    pop af
+    jp _timi_old
+timi_dispatch_3:
+    jp (hl)
+
+#endasm
+
+extern void timi_dispatch(void);
+
+uint8_t basic_timi_add(void (*fn)(void)) {
+    volatile uint8_t* hook = (volatile uint8_t*)H_TIMI;
+    uint8_t i, slot = TIMI_SLOTS;
+
+    for (i = 0; i < TIMI_SLOTS; i++) {
+        if (timi_fn[i] == fn) return 1;
+        if (!timi_fn[i] && slot == TIMI_SLOTS) slot = i;
+    }
+    if (slot == TIMI_SLOTS) return 0;
+
+    #asm
+        di
+    #endasm
+    timi_fn[slot] = fn;
+    if (!timi_hooked) {
+        /* Save the old hook and jump to the dispatcher */
+        for (i = 0; i < 5; i++) timi_old[i] = hook[i];
+        hook[0] = 0xC3;     /* jp timi_dispatch */
+        hook[1] = (uint8_t)((uint16_t)timi_dispatch & 0xFF);
+        hook[2] = (uint8_t)((uint16_t)timi_dispatch >> 8);
+        timi_hooked = 1;
+    }
+    #asm
+        ei
+    #endasm
+    return 1;
+}
+
+void basic_timi_remove(void (*fn)(void)) {
+    volatile uint8_t* hook = (volatile uint8_t*)H_TIMI;
+    uint8_t i, used = 0;
+
+    #asm
+        di
+    #endasm
+    for (i = 0; i < TIMI_SLOTS; i++) {
+        if (timi_fn[i] == fn) timi_fn[i] = 0;
+        if (timi_fn[i]) used = 1;
+    }
+    if (!used && timi_hooked) {
+        for (i = 0; i < 5; i++) hook[i] = timi_old[i];
+        timi_hooked = 0;
+    }
+    #asm
+        ei
+    #endasm
+}
 
 void basic_bios_call(uint16_t address) {
     sys_calbas(address);
@@ -645,6 +525,9 @@ void basic_init(void) {
     /* Read MSX version from BIOS ROM via RDSLT through trampoline */
     cached_msx_ver = sys_rdslt(sys_read8(0xFCC1), 0x002D);
 
+    /* Direct VRAM access writes R#14 only on MSX2 and later */
+    vram_init(cached_msx_ver >= 1);
+
     /* Hide cursor (prevents white block after CHPUT) */
     sys_write8(CSRSW, 0x00);
     /* Suppress key click sound during BIOS interrupt handling */
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) UO Soft
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file tilemap.c
+ * @brief Tile layer implementation
+ *
+ * The window is copied from the map with LDIR, 32 bytes per row. Rows
+ * that changed since a name table was last written are uploaded with one
+ * direct-port VRAM stream per run of rows.
+ */
+
+#include <stdint.h>
+#include "../../include/msxbasic/tilemap.h"
+#include "../../include/msxbasic/vram.h"
+#include "../../include/msxbasic/vdp.h"
+
+#define SCRMOD      0xFCAF
+#define T32NAM      0xF3BD  /* SCREEN 1 name table (2 bytes) */
+#define GRPNAM      0xF3C7  /* SCREEN 2 name table (2 bytes) */
+#define RG2SAV      0xF3E1  /* VDP register 2 shadow */
+
+#define sys_read8(addr)        (*(volatile uint8_t*)(addr))
+#define sys_write8(addr, val)  (*(volatile uint8_t*)(addr) = (val))
+#define sys_read16(addr)       (*(volatile uint16_t*)(addr))
+
+/* Defined in system.c */
+extern void basic_wait_vblank(void);
+
+static const uint8_t* tile_map_data;
+static uint16_t tile_width, tile_height;
+static uint8_t tile_shadow[TILE_COLS * TILE_ROWS];
+static uint16_t tile_nam[2];    /* Name table addresses */
+static uint8_t tile_flip;       /* 1: alternate tile_nam[0] and tile_nam[1] */
+static uint8_t tile_shown;      /* Index of the displayed name table */
+static uint8_t tile_dirty[TILE_ROWS];   /* Bit n: row is stale in tile_nam[n] */
+
+#asm
+
+PUBLIC _tile_rows
+
+; void tile_rows(uint8_t* dest, const uint8_t* src, uint16_t stride, uint8_t rows)
+; Copy 'rows' rows of 32 bytes; source rows are 'stride' bytes apart
+; Stack: [ret][rows][stride][src][dest]
+_tile_rows:
+    ld hl, 2
+    add hl, sp
+    ld a, (hl)      ; A = rows
+    inc hl
+    inc hl
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = stride
+    inc hl
+    push de
+    pop ix          ; IX = stride
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = src
+    inc hl
+    push de
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = dest
+    pop hl          ; HL = src
+    or a
+    ret z
+tile_rows_1:
+    push hl
+    ld bc, 32
+    ldir            ; destination rows are contiguous
+    pop hl
+    ld c, ixl
+    ld b, ixh
+    add hl, bc      ; next map row
+    dec a
+    jr nz, tile_rows_1
+    ret
+
+#endasm
+
+extern void tile_rows(uint8_t* dest, const uint8_t* src, uint16_t stride, uint8_t rows);
+
+void tile_init(const uint8_t* map, uint16_t width, uint16_t height, uint8_t flip) {
+    uint8_t mode = sys_read8(SCRMOD);
+
+    tile_map_data = map;
+    tile_width = width;
+    tile_height = height;
+
+    tile_nam[0] = (mode == 1) ? sys_read16(T32NAM) : sys_read16(GRPNAM);
+    tile_nam[1] = (mode == 4) ? 0x5800 : 0x1C00;
+    tile_flip = flip;
+    tile_shown = 0;
+
+    /* Show the first table in case a previous run left the second one */
+    if (flip) {
+        vdp_write_reg(2, (uint8_t)(tile_nam[0] >> 10));
+        sys_write8(RG2SAV, (uint8_t)(tile_nam[0] >> 10));
+    }
+
+    tile_scroll(0, 0);
+}
+
+void tile_scroll(uint16_t x, uint16_t y) {
+    uint8_t r;
+
+    if (!tile_map_data) return;
+
+    if (x > tile_width - TILE_COLS) x = tile_width - TILE_COLS;
+    if (y > tile_height - TILE_ROWS) y = tile_height - TILE_ROWS;
+
+    tile_rows(tile_shadow, tile_map_data + y * tile_width + x, tile_width, TILE_ROWS);
+    for (r = 0; r < TILE_ROWS; r++) tile_dirty[r] = 3;
+}
+
+void tile_put(uint8_t x, uint8_t y, uint8_t tile) {
+    if (x >= TILE_COLS || y >= TILE_ROWS) return;
+    tile_shadow[(uint16_t)y * TILE_COLS + x] = tile;
+    tile_dirty[y] = 3;
+}
+
+/* Write the rows that are stale in name table t, top to bottom */
+static void tile_send(uint8_t t) {
+    uint8_t bit = 1 << t;
+    uint8_t r, n;
+    uint16_t off;
+
+    for (r = 0; r < TILE_ROWS; r += n) {
+        for (n = 0; r + n < TILE_ROWS && (tile_dirty[r + n] & bit); n++) {
+            tile_dirty[r + n] &= ~bit;
+        }
+        if (n == 0) {
+            n = 1;
+            continue;
+        }
+        off = (uint16_t)r * TILE_COLS;
+        vram_ldirvm(tile_nam[t] + off, tile_shadow + off, (uint16_t)n * TILE_COLS);
+    }
+}
+
+void tile_upload(void) {
+    uint8_t r2;
+
+    if (!tile_flip) {
+        basic_wait_vblank();
+        tile_send(0);
+        return;
+    }
+
+    /* Fill the hidden table during the display, then switch at VBLANK */
+    tile_shown ^= 1;
+    tile_send(tile_shown);
+
+    r2 = (uint8_t)(tile_nam[tile_shown] >> 10);
+    basic_wait_vblank();
+    vdp_write_reg(2, r2);
+    sys_write8(RG2SAV, r2);
+}
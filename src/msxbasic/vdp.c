@@ -10,6 +10,7 @@
 
 #include <stdint.h>
 #include "../../include/msxbasic/vdp.h"
+#include "../../include/msxbasic/vram.h"
 
 /* System variables */
 #define SCRMOD      0xFCAF  /* Current screen mode */
@@ -21,13 +22,26 @@
 #define sys_read8(addr)  (*(volatile uint8_t*)(addr))
 #define sys_write8(addr, val) (*(volatile uint8_t*)(addr) = (val))
 
+/* Queue entry: 16 bytes, so the issue routine can index with shifts */
+typedef struct {
+    uint8_t reg;        /* First register sent: 32 (full) or 36 (from DX) */
+    VdpCmd cmd;
+} VdpQueueEntry;
+
+/* Command queue: ring of descriptors, head = next free, tail = next to issue */
+static VdpQueueEntry vdp_q[VDP_QUEUE_SIZE];
+static uint8_t vdp_q_head;
+static uint8_t vdp_q_tail;
+static uint16_t vdp_seq_submit;     /* Commands submitted */
+static uint16_t vdp_seq_issued;     /* Commands sent to the VDP */
+
 /* Assembly functions for VDP access */
 #asm
 
 PUBLIC _vdp_write_reg
 PUBLIC _vdp_read_status
 PUBLIC _vdp_wait_cmd
-PUBLIC _vdp_cmd_reg
+PUBLIC _vdp_xfer_send
 
 ; void vdp_write_reg(uint8_t reg, uint8_t value)
 ; Stack: [ret][value][reg]
@@ -86,70 +100,138 @@ _wait_loop:
     ei
     ret
 
-; void vdp_cmd_reg(uint8_t reg, uint8_t value)
-; Write to VDP command register (R#32-R#46)
-; Stack: [ret][value][reg]
-_vdp_cmd_reg:
+; void vdp_xfer_send(const uint8_t* src, uint16_t count)
+; Feed bytes to a running HMMC/LMMC through R#44, one per TR (S#2 bit 7).
+; Stops early if the command ends. Interrupts stay off while S#2 is selected.
+; Stack: [ret][count][src]
+_vdp_xfer_send:
     ld hl, 2
     add hl, sp
-    ld e, (hl)      ; value
+    ld c, (hl)
     inc hl
+    ld b, (hl)      ; BC = count
     inc hl
-    ld d, (hl)      ; reg
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = src
+    ld a, b
+    or c
+    ret z
     di
-    ld a, e
-    out (0x99), a   ; Write value
-    ld a, d
-    or 0x80         ; Set write flag
-    out (0x99), a   ; Write register number
+    ld a, 2         ; Select S#2
+    out (0x99), a
+    ld a, 0x8F
+    out (0x99), a
+    ld a, 0x80 + 44 ; R#17 = 44, no auto-increment
+    out (0x99), a
+    ld a, 0x80 + 17
+    out (0x99), a
+_xfer_loop:
+    in a, (0x99)
+    bit 0, a        ; CE: command finished
+    jr z, _xfer_done
+    rlca            ; TR -> carry
+    jr nc, _xfer_loop
+    ld a, (de)
+    out (0x9B), a
+    inc de
+    dec bc
+    ld a, b
+    or c
+    jr nz, _xfer_loop
+_xfer_done:
+    xor a           ; Reset to status register 0
+    out (0x99), a
+    ld a, 0x8F
+    out (0x99), a
     ei
     ret
 
-#endasm
+; Issue the oldest queued command if the VDP is idle.
+; Must be called with interrupts disabled (hook or vdp_q_pump).
+vdp_q_issue:
+    ld a, (_vdp_q_tail)
+    ld hl, _vdp_q_head
+    cp (hl)
+    ret z           ; Queue empty
+    ld a, 2         ; Select S#2
+    out (0x99), a
+    ld a, 0x8F
+    out (0x99), a
+    in a, (0x99)
+    ld b, a
+    xor a           ; Reset to status register 0
+    out (0x99), a
+    ld a, 0x8F
+    out (0x99), a
+    bit 0, b        ; CE: previous command still running
+    ret nz
+    ld a, (_vdp_q_tail)
+    ld l, a
+    ld h, 0
+    add hl, hl
+    add hl, hl
+    add hl, hl
+    add hl, hl      ; HL = tail * 16
+    ld de, _vdp_q
+    add hl, de
+    ld a, (hl)      ; First register (32 or 36)
+    inc hl
+    ld b, a
+    sub 32
+    ld e, a
+    ld d, 0
+    add hl, de      ; HL = descriptor byte of the first register
+    ld a, b
+    out (0x99), a   ; R#17 = first register, auto-increment
+    ld a, 0x80 + 17
+    out (0x99), a
+    ld a, 47
+    sub b
+    ld b, a         ; Registers up to R#46, which starts the command
+    ld c, 0x9B
+    otir
+    ld a, (_vdp_q_tail)
+    inc a
+    and 0x0F        ; VDP_QUEUE_SIZE - 1
+    ld (_vdp_q_tail), a
+    ld hl, (_vdp_seq_issued)
+    inc hl
+    ld (_vdp_seq_issued), hl
+    ret
 
-extern void vdp_cmd_reg(uint8_t reg, uint8_t value);
+; void vdp_q_pump(void)
+PUBLIC _vdp_q_pump
+_vdp_q_pump:
+    di
+    call vdp_q_issue
+    ei
+    ret
 
-void vdp_set_write_addr(uint32_t addr) {
-    uint8_t low = addr & 0xFF;
-    uint8_t mid = (addr >> 8) & 0x3F;
-    uint8_t high = (addr >> 14) & 0x07;
+; VBLANK routine (basic_timi_add): issue the next command unless a
+; transfer started through the vram_* helpers is open (vram_open)
+PUBLIC _vdp_q_timi
+_vdp_q_timi:
+    ld a, (_vram_open)
+    or a
+    ret nz
+    jp vdp_q_issue
 
-    vdp_write_reg(14, high);  /* R#14 VRAM address high bits */
+#endasm
 
-    #asm
-        di
-        ld hl, 4
-        add hl, sp
-        ld a, (hl)      ; low byte of addr
-        out (0x99), a
-        inc hl
-        ld a, (hl)      ; mid byte
-        and 0x3F
-        or 0x40         ; Set write flag
-        out (0x99), a
-        ei
-    #endasm
-}
+extern void vdp_q_pump(void);
+extern void vdp_q_timi(void);
 
-void vdp_set_read_addr(uint32_t addr) {
-    uint8_t low = addr & 0xFF;
-    uint8_t mid = (addr >> 8) & 0x3F;
-    uint8_t high = (addr >> 14) & 0x07;
+/* Defined in system.c */
+extern uint8_t basic_timi_add(void (*fn)(void));
+extern void basic_timi_remove(void (*fn)(void));
 
-    vdp_write_reg(14, high);
+void vdp_set_write_addr(uint32_t addr) {
+    vram_set_write_ex(addr);
+}
 
-    #asm
-        di
-        ld hl, 4
-        add hl, sp
-        ld a, (hl)      ; low byte
-        out (0x99), a
-        inc hl
-        ld a, (hl)      ; mid byte
-        and 0x3F
-        out (0x99), a
-        ei
-    #endasm
+void vdp_set_read_addr(uint32_t addr) {
+    vram_set_read_ex(addr);
 }
 
 void vdp_write_vram(uint8_t value) {
@@ -168,52 +250,91 @@ uint8_t vdp_read_vram(void) {
     #endasm
 }
 
-/* PSET using LMMV command inline (same code as vdp_fill but for 1x1 pixel) */
-void vdp_pset(uint16_t x, uint16_t y, uint8_t color, uint8_t op) {
-    uint8_t dx_low, dx_high, dy_low, dy_high;
+/* Queue a descriptor to be sent from register reg (32 or 36) */
+static uint16_t vdp_q_put(const VdpCmd* cmd, uint8_t reg) {
+    uint8_t next = (vdp_q_head + 1) & (VDP_QUEUE_SIZE - 1);
+    uint8_t* dst;
+    const uint8_t* src = (const uint8_t*)cmd;
+    uint8_t i;
+
+    /* Queue full: wait for the VDP to take the oldest command */
+    while (next == vdp_q_tail) vdp_q_pump();
+
+    vdp_q[vdp_q_head].reg = reg;
+    dst = (uint8_t*)&vdp_q[vdp_q_head].cmd;
+    for (i = 0; i < sizeof(VdpCmd); i++) dst[i] = src[i];
+    vdp_q_head = next;
+    vdp_seq_submit++;
+    vdp_q_pump();
+    return vdp_seq_submit;
+}
+
+uint16_t vdp_submit(const VdpCmd* cmd) {
+    return vdp_q_put(cmd, 32);
+}
 
-    (void)op;
+uint16_t vdp_submit_dx(const VdpCmd* cmd) {
+    return vdp_q_put(cmd, 36);
+}
 
-    /* Pre-compute coordinate bytes */
-    dx_low = (uint8_t)(x & 0xFF);
-    dx_high = (uint8_t)((x >> 8) & 0x01);
-    dy_low = (uint8_t)(y & 0xFF);
-    dy_high = (uint8_t)((y >> 8) & 0x03);
+uint8_t vdp_pump(void) {
+    vdp_q_pump();
+    return (vdp_q_head - vdp_q_tail) & (VDP_QUEUE_SIZE - 1);
+}
 
+void vdp_flush(void) {
+    while (vdp_pump() != 0) {
+    }
     vdp_wait_cmd();
+}
 
-    /* DX (R#36, R#37) - pixel coordinate */
-    vdp_cmd_reg(36, dx_low);
-    vdp_cmd_reg(37, dx_high);
+uint16_t vdp_fence(void) {
+    return vdp_seq_submit;
+}
 
-    /* DY (R#38, R#39) */
-    vdp_cmd_reg(38, dy_low);
-    vdp_cmd_reg(39, dy_high);
+uint8_t vdp_fence_done(uint16_t fence) {
+    int16_t ahead;
 
-    /* NX (R#40, R#41) = 1 pixel */
-    vdp_cmd_reg(40, 1);
-    vdp_cmd_reg(41, 0);
+    vdp_pump();
+    ahead = (int16_t)(vdp_seq_issued - fence);
+    if (ahead < 0) return 0;
+    if (ahead > 0) return 1;
 
-    /* NY (R#42, R#43) = 1 pixel */
-    vdp_cmd_reg(42, 1);
-    vdp_cmd_reg(43, 0);
+    /* Issued last: done once the VDP is idle */
+    return (vdp_read_status(2) & VDP_STATUS_CE) ? 0 : 1;
+}
 
-    /* Color (R#44) */
-    vdp_cmd_reg(44, color);
+void vdp_fence_wait(uint16_t fence) {
+    while (!vdp_fence_done(fence)) {
+    }
+}
 
-    /* ARG (R#45) - direction right-down */
-    vdp_cmd_reg(45, 0);
+void vdp_queue_hook(uint8_t enable) {
+    if (enable) {
+        basic_timi_add(vdp_q_timi);
+    } else {
+        basic_timi_remove(vdp_q_timi);
+    }
+}
 
-    /* Command (R#46) - LMMV */
-    vdp_cmd_reg(46, VDP_CMD_LMMV);
+void vdp_pset(uint16_t x, uint16_t y, uint8_t color, uint8_t op) {
+    VdpCmd c;
+
+    /* 1x1 LMMV with the logical operation */
+    c.dx = x & 0x1FF;
+    c.dy = y & 0x3FF;
+    c.nx = 1;
+    c.ny = 1;
+    c.clr = color;
+    c.arg = 0;
+    c.cmd = VDP_CMD_LMMV | (op & 0x0F);
+    vdp_submit_dx(&c);
 }
 
 void vdp_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color, uint8_t op) {
+    VdpCmd c;
     int16_t dx, dy;
     uint8_t arg = 0;
-    uint8_t dx_low, dx_high, dy_low, dy_high;
-    uint8_t nx_low, nx_high, ny_low, ny_high;
-    uint16_t nx_val;
 
     /* Calculate deltas */
     dx = x2 - x1;
@@ -237,126 +358,144 @@ void vdp_line(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2, uint8_t color,
         dy = tmp;
     }
 
-    /* Pre-compute all coordinate bytes */
-    dx_low = (uint8_t)(x1 & 0xFF);
-    dx_high = (uint8_t)((x1 >> 8) & 0x01);
-    dy_low = (uint8_t)(y1 & 0xFF);
-    dy_high = (uint8_t)((y1 >> 8) & 0x03);
-
-    nx_val = (uint16_t)(dx + 1);
-    nx_low = (uint8_t)(nx_val & 0xFF);
-    nx_high = (uint8_t)((nx_val >> 8) & 0x03);
-    ny_low = (uint8_t)(dy & 0xFF);
-    ny_high = (uint8_t)((dy >> 8) & 0x03);
-
-    vdp_wait_cmd();
-
-    /* DX (R#36, R#37) - start X */
-    vdp_cmd_reg(36, dx_low);
-    vdp_cmd_reg(37, dx_high);
-
-    /* DY (R#38, R#39) - start Y */
-    vdp_cmd_reg(38, dy_low);
-    vdp_cmd_reg(39, dy_high);
-
-    /* NX (R#40, R#41) - long side (number of dots) */
-    vdp_cmd_reg(40, nx_low);
-    vdp_cmd_reg(41, nx_high);
-
-    /* NY (R#42, R#43) - short side */
-    vdp_cmd_reg(42, ny_low);
-    vdp_cmd_reg(43, ny_high);
-
-    /* Color (R#44) */
-    vdp_cmd_reg(44, color);
-
-    /* ARG (R#45) */
-    vdp_cmd_reg(45, arg);
-
-    /* Command (R#46) - LINE */
-    vdp_cmd_reg(46, VDP_CMD_LINE | op);
+    c.dx = x1 & 0x1FF;              /* Start point */
+    c.dy = y1 & 0x3FF;
+    c.nx = (uint16_t)(dx + 1) & 0x3FF;  /* Long side (number of dots) */
+    c.ny = (uint16_t)dy & 0x3FF;    /* Short side */
+    c.clr = color;
+    c.arg = arg;
+    c.cmd = VDP_CMD_LINE | op;
+    vdp_submit_dx(&c);
 }
 
 void vdp_fill(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint8_t color) {
-    uint8_t dx_low, dx_high, dy_low, dy_high;
-    uint8_t nx_low, nx_high, ny_low, ny_high;
-
-    /* Pre-compute all coordinate bytes */
-    dx_low = (uint8_t)(x & 0xFF);
-    dx_high = (uint8_t)((x >> 8) & 0x01);
-    dy_low = (uint8_t)(y & 0xFF);
-    dy_high = (uint8_t)((y >> 8) & 0x03);
-    nx_low = (uint8_t)(width & 0xFF);
-    nx_high = (uint8_t)((width >> 8) & 0x03);
-    ny_low = (uint8_t)(height & 0xFF);
-    ny_high = (uint8_t)((height >> 8) & 0x03);
-
-    vdp_wait_cmd();
-
-    /* DX (R#36, R#37) - pixel coordinate */
-    vdp_cmd_reg(36, dx_low);
-    vdp_cmd_reg(37, dx_high);
-
-    /* DY (R#38, R#39) */
-    vdp_cmd_reg(38, dy_low);
-    vdp_cmd_reg(39, dy_high);
-
-    /* NX (R#40, R#41) - pixel count */
-    vdp_cmd_reg(40, nx_low);
-    vdp_cmd_reg(41, nx_high);
-
-    /* NY (R#42, R#43) */
-    vdp_cmd_reg(42, ny_low);
-    vdp_cmd_reg(43, ny_high);
-
-    /* Color (R#44) */
-    vdp_cmd_reg(44, color);
-
-    /* ARG (R#45) - direction right-down */
-    vdp_cmd_reg(45, 0);
-
-    /* Command (R#46) - LMMV (logical fill with pixel coordinates) */
-    vdp_cmd_reg(46, VDP_CMD_LMMV);
+    VdpCmd c;
+
+    /* LMMV (logical fill with pixel coordinates), direction right-down */
+    c.dx = x & 0x1FF;
+    c.dy = y & 0x3FF;
+    c.nx = width & 0x3FF;
+    c.ny = height & 0x3FF;
+    c.clr = color;
+    c.arg = 0;
+    c.cmd = VDP_CMD_LMMV;
+    vdp_submit_dx(&c);
 }
 
 void vdp_copy(uint16_t sx, uint16_t sy, uint16_t dx, uint16_t dy, uint16_t width, uint16_t height) {
-    uint8_t arg = 0;
-
-    vdp_wait_cmd();
+    VdpCmd c;
 
     /* Determine copy direction */
-    if (dx > sx) arg |= 0x04;
-    if (dy > sy) arg |= 0x08;
+    c.arg = 0;
+    if (dx > sx) c.arg |= 0x04;
+    if (dy > sy) c.arg |= 0x08;
+
+    c.sx = sx & 0x1FF;
+    c.sy = sy & 0x3FF;
+    c.dx = dx & 0x1FF;
+    c.dy = dy & 0x3FF;
+    c.nx = width & 0x3FF;
+    c.ny = height & 0x3FF;
+    c.clr = 0;
+    c.cmd = VDP_CMD_HMMM;
+    vdp_submit(&c);
+}
 
-    /* SX (R#32, R#33) */
-    vdp_cmd_reg(32, sx & 0xFF);
-    vdp_cmd_reg(33, (sx >> 8) & 0x01);
+uint16_t vdp_scroll_region(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                           int16_t lines, int16_t color) {
+    VdpCmd c;
+    uint8_t mode = vdp_get_mode();
+    uint16_t sw = SCREEN_WIDTH(mode);
+    /* Pixels per byte - 1: YMMM and HMMM move whole bytes */
+    uint8_t align = (mode == 5 || mode == 7) ? 1 : (mode == 6) ? 3 : 0;
+    uint16_t n = (lines < 0) ? (uint16_t)-lines : (uint16_t)lines;
+    uint16_t top;
+
+    if (n > height) n = height;
+    top = (lines < 0) ? y + height - n : y;
+
+    if (n < height) {
+        /* Up: copy top-down from y+n; down: copy bottom-up into the last row */
+        c.arg = (lines < 0) ? 0 : 0x08;
+        c.sy = ((lines < 0) ? y + n : y + height - 1 - n) & 0x3FF;
+        c.dy = ((lines < 0) ? y : y + height - 1) & 0x3FF;
+        c.ny = (height - n) & 0x3FF;
+        c.sx = x & 0x1FF;       /* SX and NX are ignored by YMMM */
+        c.nx = width & 0x3FF;
+        c.clr = 0;
+
+        if (x + width == sw && !(x & align)) {
+            /* YMMM from dx to the right edge */
+            c.dx = x;
+            c.cmd = VDP_CMD_YMMM;
+        } else if (x == 0 && !(width & align)) {
+            /* YMMM from dx to the left edge */
+            c.dx = width - 1;
+            c.arg |= 0x04;
+            c.cmd = VDP_CMD_YMMM;
+        } else {
+            /* HMMM moves whole bytes, so a band that does not start and
+             * end on a byte would drag its neighbours' pixels along:
+             * move those pixel by pixel with LMMM */
+            c.dx = x & 0x1FF;
+            c.cmd = ((x | width) & align) ? (VDP_CMD_LMMM | VDP_LOG_IMP) : VDP_CMD_HMMM;
+        }
+        vdp_submit(&c);
+    }
 
-    /* SY (R#34, R#35) */
-    vdp_cmd_reg(34, sy & 0xFF);
-    vdp_cmd_reg(35, (sy >> 8) & 0x03);
+    if (color >= 0 && n) vdp_fill(x, top, width, n, (uint8_t)color);
+    return top;
+}
 
-    /* DX (R#36, R#37) */
-    vdp_cmd_reg(36, dx & 0xFF);
-    vdp_cmd_reg(37, (dx >> 8) & 0x01);
+void vdp_xfer_start(uint16_t x, uint16_t y, uint16_t width, uint16_t height,
+                    uint8_t first, uint8_t cmd) {
+    VdpCmd c;
+
+    /* The transfer must start now: drain the queue, then it issues at once */
+    vdp_flush();
+
+    c.dx = x & 0x1FF;
+    c.dy = y & 0x3FF;
+    c.nx = width & 0x3FF;
+    c.ny = height & 0x3FF;
+    c.clr = first;          /* First byte of the transfer */
+    c.arg = 0;              /* Direction right-down */
+    c.cmd = cmd;            /* HMMC or LMMC | logical operation */
+    vdp_submit_dx(&c);
+}
 
-    /* DY (R#38, R#39) */
-    vdp_cmd_reg(38, dy & 0xFF);
-    vdp_cmd_reg(39, (dy >> 8) & 0x03);
+void vdp_search_start(uint16_t x, uint16_t y, uint8_t color, uint8_t arg) {
+    VdpCmd c;
+
+    c.sx = x & 0x1FF;
+    c.sy = y & 0x3FF;
+    c.dx = 0;
+    c.dy = 0;
+    c.nx = 0;
+    c.ny = 0;
+    c.clr = color;
+    c.arg = arg & (VDP_SRCH_LEFT | VDP_SRCH_NE);    /* Direction and EQ */
+    c.cmd = VDP_CMD_SRCH;
+    vdp_submit(&c);
+}
 
-    /* NX (R#40, R#41) */
-    vdp_cmd_reg(40, width & 0xFF);
-    vdp_cmd_reg(41, (width >> 8) & 0x03);
+int16_t vdp_search_result(void) {
+    uint8_t bx_low;
 
-    /* NY (R#42, R#43) */
-    vdp_cmd_reg(42, height & 0xFF);
-    vdp_cmd_reg(43, (height >> 8) & 0x03);
+    /* The search may still be queued behind other commands */
+    vdp_flush();
 
-    /* ARG (R#45) */
-    vdp_cmd_reg(45, arg);
+    /* BD (S#2 bit 4) is set when the search condition was met */
+    if (!(vdp_read_status(2) & VDP_STATUS_BD)) return -1;
+
+    /* BX (S#8, S#9 bit 0) */
+    bx_low = vdp_read_status(8);
+    return (int16_t)(((uint16_t)(vdp_read_status(9) & 0x01) << 8) | bx_low);
+}
 
-    /* Command (R#46) - HMMM */
-    vdp_cmd_reg(46, VDP_CMD_HMMM);
+int16_t vdp_search(uint16_t x, uint16_t y, uint8_t color, uint8_t arg) {
+    vdp_search_start(x, y, color, arg);
+    return vdp_search_result();
 }
 
 /* Static variables for palette */
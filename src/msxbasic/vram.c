@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) UO Soft
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file vram.c
+ * @brief Direct-port VRAM streaming implementation
+ *
+ * The address is written once to port 0x99 and the data is streamed
+ * through port 0x98 with OUTI/INI. Each transfer loop takes 29 T-states
+ * per byte including the M1 wait, the minimum safe interval for the
+ * TMS9918 during active display.
+ */
+
+#include <stdint.h>
+#include "../../include/msxbasic/vram.h"
+
+/* 1 when R#14 (A14-A16) must be written on address setup (MSX2+) */
+static uint8_t vram_ext;
+
+/* Set by every address setup; see vram.h */
+uint8_t vram_open;
+uint8_t vram_r14;
+
+#asm
+
+PUBLIC _vram_set_write
+PUBLIC _vram_set_read
+PUBLIC _vram_set_write_ex
+PUBLIC _vram_set_read_ex
+PUBLIC _vram_write
+PUBLIC _vram_read
+PUBLIC _vram_fill
+PUBLIC _vram_put
+PUBLIC _vram_get
+PUBLIC _vram_peek
+PUBLIC _vram_poke
+
+; Common address setup
+; In: DE = address (A0-A15), C = 0x40 write / 0x00 read
+vram_setaddr16:
+    ld a, d
+    rlca
+    rlca
+    and 0x03        ; A14-A15 -> R#14 bits 0-1
+; In: A = R#14 value, DE = address, C = 0x40 write / 0x00 read
+vram_setaddr:
+    di
+    ld b, a
+    ld a, 1
+    ld (_vram_open), a
+    ld a, (_vram_ext)
+    or a
+    jr z, vram_setaddr_1
+    ld a, b
+    ld (_vram_r14), a
+    out (0x99), a
+    ld a, 0x80 + 14
+    out (0x99), a
+vram_setaddr_1:
+    ld a, e
+    out (0x99), a
+    ld a, d
+    and 0x3F
+    or c
+    out (0x99), a
+    ei
+    ret
+
+; void vram_set_write(uint16_t addr) / vram_set_read(uint16_t addr)
+; Stack: [ret][addr]
+_vram_set_write:
+    ld c, 0x40
+    jr vram_set16
+_vram_set_read:
+    ld c, 0x00
+vram_set16:
+    ld hl, 2
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)
+    jr vram_setaddr16
+
+; void vram_set_write_ex(uint32_t addr) / vram_set_read_ex(uint32_t addr)
+; Stack: [ret][addr low word][addr high word]
+_vram_set_write_ex:
+    ld c, 0x40
+    jr vram_set17
+_vram_set_read_ex:
+    ld c, 0x00
+vram_set17:
+    ld hl, 2
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)
+    inc hl
+    ld a, (hl)      ; A16
+    and 0x01
+    add a, a
+    add a, a        ; A16 -> bit 2
+    ld b, a
+    ld a, d
+    rlca
+    rlca
+    and 0x03        ; A14-A15 -> bits 0-1
+    or b
+    jr vram_setaddr
+
+; void vram_write(const uint8_t* src, uint16_t count)
+; Stack: [ret][count][src]
+_vram_write:
+    ld hl, 2
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = count
+    inc hl
+    ld a, (hl)
+    inc hl
+    ld h, (hl)
+    ld l, a         ; HL = src
+    ld a, d
+    or e
+    ret z
+    ld b, e         ; B = partial block, D = number of passes
+    ld a, e
+    or a
+    jr z, vram_write_1
+    inc d
+vram_write_1:
+    ld c, 0x98
+vram_write_2:
+    outi
+    jp nz, vram_write_2
+    dec d
+    jp nz, vram_write_2
+    ret
+
+; void vram_read(uint8_t* dest, uint16_t count)
+; Stack: [ret][count][dest]
+_vram_read:
+    ld hl, 2
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = count
+    inc hl
+    ld a, (hl)
+    inc hl
+    ld h, (hl)
+    ld l, a         ; HL = dest
+    ld a, d
+    or e
+    ret z
+    ld b, e
+    ld a, e
+    or a
+    jr z, vram_read_1
+    inc d
+vram_read_1:
+    ld c, 0x98
+vram_read_2:
+    ini
+    jp nz, vram_read_2
+    dec d
+    jp nz, vram_read_2
+    ret
+
+; void vram_fill(uint8_t value, uint16_t count)
+; Stack: [ret][count][value]
+_vram_fill:
+    ld hl, 2
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)      ; DE = count
+    inc hl
+    ld l, (hl)      ; L = value
+    ld a, d
+    or e
+    ret z
+    ld b, e
+    ld a, e
+    or a
+    jr z, vram_fill_1
+    inc d
+vram_fill_1:
+    ld a, l
+vram_fill_2:
+    out (0x98), a
+    nop             ; pad to 29 T-states per byte
+    djnz vram_fill_2
+    dec d
+    jp nz, vram_fill_2
+    ret
+
+; void vram_put(uint8_t value)
+; Stack: [ret][value]
+_vram_put:
+    ld hl, 2
+    add hl, sp
+    ld a, (hl)
+    out (0x98), a
+    ret
+
+; uint8_t vram_get(void)
+_vram_get:
+    in a, (0x98)
+    ld l, a
+    ret
+
+; uint8_t vram_peek(uint16_t addr)
+; Stack: [ret][addr]
+_vram_peek:
+    ld hl, 2
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)
+    ld c, 0x00
+    call vram_setaddr16
+    in a, (0x98)
+    ld l, a
+    xor a
+    ld (_vram_open), a
+    ret
+
+; void vram_poke(uint16_t addr, uint8_t value)
+; Stack: [ret][value][addr]
+_vram_poke:
+    ld hl, 4
+    add hl, sp
+    ld e, (hl)
+    inc hl
+    ld d, (hl)
+    ld c, 0x40
+    call vram_setaddr16
+    ld hl, 2
+    add hl, sp
+    ld a, (hl)
+    out (0x98), a
+    xor a
+    ld (_vram_open), a
+    ret
+
+#endasm
+
+void vram_init(uint8_t ext) {
+    vram_ext = ext;
+}
+
+void vram_close(void) {
+    vram_open = 0;
+}
+
+uint8_t vram_peek_ex(uint32_t addr) {
+    uint8_t value;
+
+    vram_set_read_ex(addr);
+    value = vram_get();
+    vram_open = 0;
+    return value;
+}
+
+void vram_poke_ex(uint32_t addr, uint8_t value) {
+    vram_set_write_ex(addr);
+    vram_put(value);
+    vram_open = 0;
+}
+
+void vram_ldirvm(uint16_t dest, const uint8_t* src, uint16_t count) {
+    vram_set_write(dest);
+    vram_write(src, count);
+    vram_open = 0;
+}
+
+void vram_ldirmv(uint8_t* dest, uint16_t src, uint16_t count) {
+    vram_set_read(src);
+    vram_read(dest, count);
+    vram_open = 0;
+}
+
+void vram_filvrm(uint16_t addr, uint16_t count, uint8_t value) {
+    vram_set_write(addr);
+    vram_fill(value, count);
+    vram_open = 0;
+}